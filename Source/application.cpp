@@ -243,6 +243,11 @@ bool MsgSleep(int aSleepDuration, MessageMode aMode)
 			// (if they're installed).  Otherwise, there's greater risk of keyboard/mouse lag.
 			// PeekMessage(), depending on how, and how often it's called, will also do this, but
 			// I'm not as confident in it.
+			// Before waiting, close any files FileAppend is holding open so that they aren't held open
+			// while the script sleeps (which would prevent other processes from renaming or deleting
+			// them, such as to rotate a log):
+			if (Line::sFileAppendCacheCount)
+				Line::FileAppendCacheClose();
 			if (GetMessage(&msg, NULL, 0, MSG_FILTER_MAX) == -1) // -1 is an error, 0 means WM_QUIT
 				continue; // Error probably happens only when bad parameters were passed to GetMessage().
 			//else let any WM_QUIT be handled below.
@@ -444,7 +449,7 @@ bool MsgSleep(int aSleepDuration, MessageMode aMode)
 
 		// For max. flexibility, it seems best to allow the message filter to have the first
 		// crack at looking at the message, before even TRANSLATE_AHK_MSG:
-		if (g_MsgMonitorCount && MsgMonitor(msg.hwnd, msg.message, msg.wParam, msg.lParam, &msg, msg_reply))  // Count is checked here to avoid function-call overhead.
+		if (MSG_MAY_BE_MONITORED(msg.message) && MsgMonitor(msg.hwnd, msg.message, msg.wParam, msg.lParam, &msg, msg_reply))  // Filter is checked here to avoid function-call overhead.
 		{
 			continue; // MsgMonitor has returned "true", indicating that this message should be omitted from further processing.
 			// NOTE: Above does "continue" and ignores msg_reply.  This is because testing shows that
@@ -1532,30 +1537,37 @@ bool CheckScriptTimers()
 	if (g_nPausedThreads > 0 || !g->AllowTimers || g_nThreads >= g_MaxThreadsTotal || !IsInterruptible()) // See above.
 		return false;
 
-	ScriptTimer *ptimer;
+	// The enabled timers are kept in a heap ordered by due-time, so the common case of no timer being
+	// due is detected here without having to look at every timer:
+	unsigned __int64 tick_start = GetTickCount64Ex();
+	if (tick_start < g_script.mTimerHeap[0]->DueTime())
+		return false;
+
+	// Otherwise, fetch the timers that are due (in linked-list order).  If there are more than will fit,
+	// the rest will be launched by the next call, which happens very soon since they're still due.
+	#define MAX_DUE_TIMERS_PER_CHECK 64
+	ScriptTimer *due_timer[MAX_DUE_TIMERS_PER_CHECK];
+	int due_count = g_script.GetDueTimers(due_timer, MAX_DUE_TIMERS_PER_CHECK, tick_start, g->Priority);
+
 	BOOL at_least_one_timer_launched;
-	DWORD tick_start;
 	char ErrorLevel_saved[ERRORLEVEL_SAVED_SIZE];
 
 	// Note: It seems inconsequential if a subroutine that the below loop executes causes a
 	// new timer to be added to the linked list while the loop is still enumerating the timers.
+	// Any such timer isn't in due_timer, so it will be handled by a later call.
 
-	for (at_least_one_timer_launched = FALSE, ptimer = g_script.mFirstTimer
-		; ptimer != NULL
-		; ptimer = ptimer->mNextTimer)
+	at_least_one_timer_launched = FALSE;
+	for (int i = 0; i < due_count; ++i)
 	{
-		ScriptTimer &timer = *ptimer; // For performance and convenience.
+		ScriptTimer &timer = *due_timer[i]; // For performance and convenience.
+		// A prior iteration's subroutine might have disabled or reset this timer, so check everything again:
 		if (!timer.mEnabled || timer.mExistingThreads > 0 || timer.mPriority < g->Priority) // thread priorities
 			continue;
 
-		tick_start = GetTickCount(); // Call GetTickCount() every time in case a previous iteration of the loop took a long time to execute.
-		// As of v1.0.36.03, the following subtracts two DWORDs to support intervals of 49.7 vs. 24.8 days.
-		// This should work as long as the distance between the values being compared isn't greater than
-		// 49.7 days. This is because 1 minus 2 in unsigned math yields 0xFFFFFFFF milliseconds (49.7 days).
-		// If the distance between time values is greater than 49.7 days (perhaps because the computer was
-		// suspended/hibernated for 50+ days), the next launch of the affected timer(s) will be delayed
-		// by up to 100% of their periods.  See IsInterruptible() for more discussion.
-		if (tick_start - timer.mTimeLastRun < (DWORD)timer.mPeriod) // Timer is not yet due to run.
+		tick_start = GetTickCount64Ex(); // Call it every time in case a previous iteration of the loop took a long time to execute.
+		// Since the tick count is 64-bit, there's no need to worry about it wrapping around every 49.7 days
+		// (see GetTickCount64Ex() for details).
+		if (tick_start < timer.DueTime()) // Timer is not yet due to run (probably because it was reset by a prior iteration).
 			continue;
 		// Otherwise, this timer is due to run.
 		if (!at_least_one_timer_launched) // This will be the first timer launched here.
@@ -1596,11 +1608,13 @@ bool CheckScriptTimers()
 		timer.mTimeLastRun = tick_start;
 		if (timer.mRunOnlyOnce)
 			timer.Disable();  // This is done prior to launching the thread for reasons similar to above.
+		else
+			g_script.TimerHeapUpdate(&timer); // Move it to its new position according to its new due-time.
 
 		// v1.0.38.04: The following line is done prior to the timer launch to reduce situations
 		// in which a timer thread is interrupted before it can execute even a single line.
 		// Search for mLastPeekTime in MsgSleep() for detailed explanation.
-		g_script.mLastPeekTime = tick_start; // It's valid to reset this because by definition, "msg" just came in to our caller via Get() or Peek(), both of which qualify as a Peek() for this purpose.
+		g_script.mLastPeekTime = (DWORD)tick_start; // It's valid to reset this because by definition, "msg" just came in to our caller via Get() or Peek(), both of which qualify as a Peek() for this purpose.
 
 		// This next line is necessary in case a prior iteration of our loop invoked a different
 		// timed subroutine that changed any of the global struct's values.  In other words, make
@@ -1716,7 +1730,9 @@ bool MsgMonitor(HWND aWnd, UINT aMsg, WPARAM awParam, LPARAM alParam, MSG *apMsg
 		return false;
 
 	// Linear search vs. binary search should perform better on average because the vast majority
-	// of message monitoring scripts are expected to monitor only a few message numbers.
+	// of message monitoring scripts are expected to monitor only a few message numbers.  In any case,
+	// callers have already used MSG_MAY_BE_MONITORED() to filter out unmonitored messages, so this
+	// search is done only for messages that are about to launch a monitor function.
 	int msg_index, msg_count_orig;
 	for (msg_count_orig = g_MsgMonitorCount, msg_index = 0; msg_index < g_MsgMonitorCount; ++msg_index)
 		if (g_MsgMonitor[msg_index].msg == aMsg)
@@ -1975,6 +1991,7 @@ void InitNewThread(int aPriority, bool aSkipUninterruptible, bool aIncrementThre
 
 void ResumeUnderlyingThread(char *aSavedErrorLevel)
 {
+	GuiType::EndThreadUpdates(); // Must be done while "g" is still the thread that's finishing.
 	// The following section handles the switch-over to the former/underlying "g" item:
 	--g_nThreads; // Other sections below might rely on this having been done early.
 	--g;
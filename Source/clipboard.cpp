@@ -20,6 +20,26 @@ GNU General Public License for more details.
 #include "application.h" // for MsgSleep()
 #include "util.h" // for strlcpy()
 
+// Dynamically resolve GetClipboardSequenceNumber() because it doesn't exist on Win9x/NT4:
+typedef DWORD (WINAPI *MyGetClipboardSequenceNumberType)();
+static MyGetClipboardSequenceNumberType sMyGetClipboardSequenceNumber = (MyGetClipboardSequenceNumberType)
+	GetProcAddress(GetModuleHandle("user32"), "GetClipboardSequenceNumber");
+// Above will be NULL for Win9x/NT4, in which case the cache is never used.
+
+
+
+bool Clipboard::CacheIsCurrent()
+// Returns true if mCache still reflects what's on the clipboard.  This is much faster than opening the
+// clipboard because GetClipboardSequenceNumber() merely reads a counter that the OS increments whenever
+// the contents change.
+{
+	return mCacheSequence && sMyGetClipboardSequenceNumber && sMyGetClipboardSequenceNumber() == mCacheSequence;
+	// Above: GetClipboardSequenceNumber() yields 0 when it can't access the window station, which never
+	// matches because mCacheSequence is never set to 0 except to invalidate it.
+}
+
+
+
 size_t Clipboard::Get(char *aBuf)
 // If aBuf is NULL, it returns the length of the text on the clipboard and leaves the
 // clipboard open.  Otherwise, it copies the clipboard text into aBuf and closes
@@ -40,6 +60,21 @@ size_t Clipboard::Get(char *aBuf)
 		// a zero terminator, so this would have no effect:
 		*aBuf = '\0';
 
+	if (mCacheInUse || !mIsOpen && CacheIsCurrent())
+	{
+		// Serve it from the cache.  Once a length has been reported from the cache, keep using the cache
+		// (even if the clipboard has since changed) until Close() so that the text copied into aBuf is the
+		// same size as what the caller was told.
+		if (!mCacheInUse)
+		{
+			mCacheInUse = true;
+			++mCacheHits;
+		}
+		if (aBuf)
+			memcpy(aBuf, mCache, mCacheLength + 1); // Caller has already ensured that aBuf is large enough.
+		return mCacheLength;
+	}
+
 	UINT i, file_count = 0;
 	BOOL clipboard_contains_text = IsClipboardFormatAvailable(CF_TEXT);
 	BOOL clipboard_contains_files = IsClipboardFormatAvailable(CF_HDROP);
@@ -70,6 +105,10 @@ size_t Clipboard::Get(char *aBuf)
 			Close(CANT_OPEN_CLIPBOARD_READ);
 			return CLIPBOARD_FAILURE;
 		}
+		// Now that the clipboard is open, its contents can't change until it's closed, so this is the
+		// sequence number of what's about to be read:
+		mOpenSequence = sMyGetClipboardSequenceNumber ? sMyGetClipboardSequenceNumber() : 0;
+		++mCacheMisses;
 		if (   !(mClipMemNow = g_clip.GetClipboardDataTimeout(clipboard_contains_files ? CF_HDROP : CF_TEXT))   )
 		{
 			// v1.0.47.04: Commented out the following that had been in effect when clipboard_contains_files==false:
@@ -136,6 +175,7 @@ size_t Clipboard::Get(char *aBuf)
 		// the overhead of having to close and reopen the clipboard.
 
 	// Otherwise:
+	char *buf_orig = aBuf;
 	if (clipboard_contains_files)
 	{
 		if (file_count = DragQueryFile((HDROP)mClipMemNowLocked, 0xFFFFFFFF, "", 0))
@@ -154,6 +194,31 @@ size_t Clipboard::Get(char *aBuf)
 	}
 	else
 		strcpy(aBuf, mClipMemNowLocked);  // Caller has already ensured that aBuf is large enough.
+
+	// Cache what was just retrieved so that subsequent references to the clipboard don't need to open it
+	// again unless its contents change:
+	if (mOpenSequence && mLength <= CLIPBOARD_CACHE_MAX_LENGTH)
+	{
+		if (mCacheCapacity < mLength + 1)
+		{
+			// Use a temp var. because realloc() returns NULL on failure but leaves original block allocated.
+			char *new_cache = (char *)realloc(mCache, mLength + 1);
+			if (new_cache)
+			{
+				mCache = new_cache;
+				mCacheCapacity = mLength + 1;
+			}
+			else // Just leave the cache invalid; it's only an optimization.
+				mCacheSequence = 0;
+		}
+		if (mCacheCapacity >= mLength + 1)
+		{
+			memcpy(mCache, buf_orig, mLength + 1);
+			mCacheLength = mLength;
+			mCacheIsFiles = clipboard_contains_files;
+			mCacheSequence = mOpenSequence;
+		}
+	}
 	// Fix for v1.0.37: Close() is no longer called here because it prevents the clipboard variable
 	// from being referred to more than once in a line.  For example:
 	// Msgbox %Clipboard%%Clipboard%
@@ -249,6 +314,7 @@ ResultType Clipboard::Commit(UINT aFormat)
 		Close();
 		return AbortWrite("EmptyClipboard"); // Short error message since so rare.
 	}
+	InvalidateCache(); // Although the sequence number will change anyway, this ensures our own writes are never masked.
 	if (mClipMemNew)
 	{
 		bool new_is_empty = false;
@@ -331,6 +397,8 @@ ResultType Clipboard::Close(char *aErrorMessage)
 		// Must do this only after GlobalUnlock():
 		mClipMemNow = NULL;
 	}
+	mCacheInUse = false; // The next read will recheck whether the cache is still current.
+	mOpenSequence = 0;
 	// Do this cleanup for callers that didn't make it far enough to even open the clipboard.
 	// UPDATE: DO *NOT* do this because it is valid to have the clipboard in a "ReadyForWrite"
 	// state even after we physically close it.  Some callers rely on that.
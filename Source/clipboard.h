@@ -34,6 +34,23 @@ public:
 	UINT mCapacity;  // Capacity of mClipMemNewLocked.
 	BOOL mIsOpen;  // Whether the clipboard is physically open due to action by this class.  BOOL vs. bool improves some benchmarks slightly due to this item being frequently checked.
 
+	// The following cache the text most recently retrieved by Get(aBuf), keyed by the clipboard's sequence
+	// number.  This allows repeated references to %Clipboard% (such as by a timer that polls it, or by a line
+	// that refers to it more than once) to avoid reopening the clipboard and re-transcribing any CF_HDROP file
+	// list when the clipboard hasn't changed.  mCacheInUse serves the same purpose for the cache that mIsOpen
+	// serves for the clipboard itself: once a length has been reported from the cache, the cache is used for
+	// the follow-up call(s) that copy the text even if the clipboard changes in the meantime, which prevents
+	// buffer overflow in the caller.
+	#define CLIPBOARD_CACHE_MAX_LENGTH (1024 * 1024) // Larger contents aren't cached to avoid keeping a second copy of huge amounts of text.
+	char *mCache;
+	size_t mCacheLength;
+	size_t mCacheCapacity;
+	DWORD mCacheSequence;   // Sequence number of the clipboard contents in mCache.  Zero means the cache is invalid.
+	DWORD mOpenSequence;    // Sequence number of the contents the clipboard had when Get() last opened it (0 if unknown).
+	bool mCacheIsFiles;     // Whether mCache is a transcribed CF_HDROP list rather than CF_TEXT.
+	bool mCacheInUse;
+	UINT mCacheHits, mCacheMisses; // Statistics of how often Get() was served by the cache (shown by KeyHistory).
+
 	// It seems best to default to many attempts, because a failure
 	// to open the clipboard may result in the early termination
 	// of a large script due to the fear that it's generally
@@ -50,6 +67,7 @@ public:
 
 	#define CLIPBOARD_FAILURE UINT_MAX
 	size_t Get(char *aBuf = NULL);
+	void InvalidateCache() {mCacheSequence = 0;}
 
 	ResultType Set(char *aBuf = NULL, UINT aLength = UINT_MAX); //, bool aTrimIt = false);
 	char *PrepareForWrite(size_t aAllocSize);
@@ -62,6 +80,9 @@ public:
 			// Its set up for being written to, which takes precedence over the fact
 			// that it may be open for read also, so return the write-buffer:
 			return mClipMemNewLocked;
+		if (mCacheInUse || !mIsOpen && CacheIsCurrent())
+			// Serve it from the cache, but report a list of files the same way as below:
+			return mCacheIsFiles ? "<<>>" : ((Get() == CLIPBOARD_FAILURE) ? "" : mCache);
 		if (!IsClipboardFormatAvailable(CF_TEXT))
 			// We check for both CF_TEXT and CF_HDROP in case it's possible for
 			// the clipboard to contain both formats simultaneously.  In this case,
@@ -74,11 +95,15 @@ public:
 			return (Get() == CLIPBOARD_FAILURE) ? "" : mClipMemNowLocked;
 	}
 
+	bool CacheIsCurrent();
+
 	Clipboard() // Constructor
 		: mIsOpen(false)  // Assumes our app doesn't already have it open.
 		, mClipMemNow(NULL), mClipMemNew(NULL)
 		, mClipMemNowLocked(NULL), mClipMemNewLocked(NULL)
 		, mLength(0), mCapacity(0)
+		, mCache(NULL), mCacheLength(0), mCacheCapacity(0), mCacheSequence(0), mOpenSequence(0)
+		, mCacheIsFiles(false), mCacheInUse(false), mCacheHits(0), mCacheMisses(0)
 	{}
 };
 
@@ -320,6 +320,14 @@ enum enum_act_old {
 #define ACT_IS_ALWAYS_ALLOWED(ActionType) (ActionType == ACT_EXITAPP || ActionType == ACT_PAUSE \
 	|| ActionType == ACT_EDIT || ActionType == ACT_RELOAD || ActionType == ACT_KEYHISTORY \
 	|| ActionType == ACT_LISTLINES || ActionType == ACT_LISTVARS || ActionType == ACT_LISTHOTKEYS)
+// Commands that must not run while FileAppend still holds one of its cached output files open, either
+// because they operate on files (which might be that file) or because they let some other process or
+// a new working directory come into play.  ACT_FILEAPPEND through ACT_FILECREATESHORTCUT are contiguous
+// in the enum above; ACT_FILEAPPEND itself is excluded since it's the one using the cache:
+#define ACT_CLOSES_FILE_APPEND_CACHE(ActionType) (ActionType > ACT_FILEAPPEND && ActionType <= ACT_FILECREATESHORTCUT \
+	|| ActionType == ACT_RUN || ActionType == ACT_RUNWAIT || ActionType == ACT_URLDOWNLOADTOFILE \
+	|| ActionType == ACT_INIREAD || ActionType == ACT_INIWRITE || ActionType == ACT_INIDELETE \
+	|| ActionType == ACT_RELOAD || ActionType == ACT_EDIT)
 #define ACT_IS_ASSIGN(ActionType) (ActionType <= ACT_ASSIGN_LAST && ActionType >= ACT_ASSIGN_FIRST) // Ordered for short-circuit performance.
 #define ACT_IS_IF(ActionType) (ActionType >= ACT_FIRST_IF && ActionType <= ACT_LAST_IF)
 #define ACT_IS_IF_OR_ELSE_OR_LOOP(ActionType) (ACT_IS_IF(ActionType) || ActionType == ACT_ELSE \
@@ -350,6 +358,7 @@ enum enum_act_old {
 #define MAX_GUI_WINDOWS 99  // Things that parse the "NN:" prefix for Gui/GuiControl might rely on this being 2-digit.
 #define MAX_GUI_WINDOWS_STR "99" // Keep this in sync with above.
 #define MAX_MSG_MONITORS 500
+#define MSG_MONITOR_FILTER_SIZE 0x10000 // Number of message numbers covered by g_MsgMonitorFilter (all system, WM_USER, WM_APP and registered messages).
 
 // IMPORTANT: Before ever changing the below, note that it will impact the IDs of menu items created
 // with the MENU command, as well as the number of such menu items that are possible (currently about
@@ -386,7 +395,7 @@ typedef UCHAR HookType;
 #define EXTERN_OSVER extern OS_Version g_os
 #define EXTERN_CLIPBOARD extern Clipboard g_clip
 #define EXTERN_SCRIPT extern Script g_script
-#define CLOSE_CLIPBOARD_IF_OPEN	if (g_clip.mIsOpen) g_clip.Close()
+#define CLOSE_CLIPBOARD_IF_OPEN	if (g_clip.mIsOpen || g_clip.mCacheInUse) g_clip.Close()
 #define CLIPBOARD_CONTAINS_ONLY_FILES (!IsClipboardFormatAvailable(CF_TEXT) && IsClipboardFormatAvailable(CF_HDROP))
 
 
@@ -121,6 +121,7 @@ GuiType *g_gui[MAX_GUI_WINDOWS] = {NULL};
 HWND g_hWndToolTip[MAX_TOOLTIPS] = {NULL};
 MsgMonitorStruct *g_MsgMonitor = NULL; // An array to be allocated upon first use (if any).
 int g_MsgMonitorCount = 0;
+UCHAR g_MsgMonitorFilter[MSG_MONITOR_FILTER_SIZE / 8] = {0}; // A bit for each message number that has a msg-monitor.
 
 // Init not needed for these:
 UCHAR g_SortCaseSensitive;
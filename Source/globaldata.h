@@ -109,6 +109,15 @@ EXTERN_GUI;
 extern HWND g_hWndToolTip[MAX_TOOLTIPS];
 extern MsgMonitorStruct *g_MsgMonitor; // An array to be allocated upon first use (if any).
 extern int g_MsgMonitorCount;
+extern UCHAR g_MsgMonitorFilter[MSG_MONITOR_FILTER_SIZE / 8];
+// Callers use the following to avoid calling MsgMonitor() for the vast majority of messages, which aren't
+// monitored.  It has a bit set for each message number that has a msg-monitor, so it costs the same
+// regardless of how many messages are being monitored.  Message numbers too large for the bitmap (which
+// are very rare) are always passed to MsgMonitor() to be checked the long way:
+#define MSG_MAY_BE_MONITORED(aMsg) (g_MsgMonitorCount && ((aMsg) >= MSG_MONITOR_FILTER_SIZE \
+	|| (g_MsgMonitorFilter[(aMsg) >> 3] & (1 << ((aMsg) & 7)))))
+#define MSG_MONITOR_FILTER_SET(aMsg) ((aMsg) < MSG_MONITOR_FILTER_SIZE ? g_MsgMonitorFilter[(aMsg) >> 3] |= (1 << ((aMsg) & 7)) : 0)
+#define MSG_MONITOR_FILTER_CLEAR(aMsg) ((aMsg) < MSG_MONITOR_FILTER_SIZE ? g_MsgMonitorFilter[(aMsg) >> 3] &= ~(1 << ((aMsg) & 7)) : 0)
 
 extern UCHAR g_SortCaseSensitive;
 extern bool g_SortNumeric;
@@ -3678,6 +3678,7 @@ ResultType LayoutHasAltGr(HKL aLayout, ResultType aHasAltGr)
 	CachedLayoutType &cl = sCachedLayout[(i < MAX_CACHED_LAYOUTS) ? i : MAX_CACHED_LAYOUTS-1];
 	if (aHasAltGr != LAYOUT_UNDETERMINED) // Caller determined it for us.  See top of function for explanation.
 	{
+		cl.vk_scan_is_ready = false; // In case this slot previously held a different layout.
 		cl.hkl = aLayout;
 		return cl.has_altgr = aHasAltGr;
 	}
@@ -3691,6 +3692,7 @@ ResultType LayoutHasAltGr(HKL aLayout, ResultType aHasAltGr)
 	// Performance: This loop is quite fast. Doing this section 1000 times only takes about 160ms
 	// on a 2gHz system (0.16ms per call).
 	SHORT s; // Also, an int is used for "i" vs. char to avoid overflow on final character.
+	cl.vk_scan_is_ready = false; // In case this slot previously held a different layout.
 	for (cl.has_altgr = LAYOUT_UNDETERMINED, i = 32; i < 256; ++i) // Include Spacebar up through final ANSI character (i.e. include 255 but not 256).
 	{
 		s = VkKeyScanEx((char)i, aLayout);
@@ -3710,6 +3712,35 @@ ResultType LayoutHasAltGr(HKL aLayout, ResultType aHasAltGr)
 
 
 
+SHORT CachedVkKeyScan(char aChar, HKL aKeybdLayout)
+// Returns the same thing as VkKeyScanEx(aChar, aKeybdLayout), but looks it up in a table that is built
+// once per cached layout.  This greatly reduces the cost of translating each character of long Send
+// strings, especially ones sent repeatedly by hotkeys.
+// Thread-safety: See comments in LayoutHasAltGr().
+{
+	if (!aKeybdLayout) // Special values like 0 aren't supported by the layout cache.
+		return VkKeyScanEx(aChar, aKeybdLayout);
+	int i;
+	for (i = 0; i < MAX_CACHED_LAYOUTS && sCachedLayout[i].hkl != aKeybdLayout; ++i);
+	if (i == MAX_CACHED_LAYOUTS) // This layout isn't cached yet, so have LayoutHasAltGr() add it.
+	{
+		LayoutHasAltGr(aKeybdLayout);
+		for (i = 0; i < MAX_CACHED_LAYOUTS && sCachedLayout[i].hkl != aKeybdLayout; ++i);
+		if (i == MAX_CACHED_LAYOUTS) // Should be impossible, but just in case.
+			return VkKeyScanEx(aChar, aKeybdLayout);
+	}
+	CachedLayoutType &cl = sCachedLayout[i];
+	if (!cl.vk_scan_is_ready)
+	{
+		for (i = 0; i < 256; ++i) // An int is used for "i" vs. char to avoid overflow on final character.
+			cl.vk_scan[i] = VkKeyScanEx((char)i, aKeybdLayout);
+		cl.vk_scan_is_ready = true; // Done only after the table is complete.
+	}
+	return cl.vk_scan[(UCHAR)aChar];
+}
+
+
+
 char *SCtoKeyName(sc_type aSC, char *aBuf, int aBufSize)
 // aBufSize is an int so that any negative values passed in from caller are not lost.
 // Always produces a non-empty string.
@@ -3748,12 +3779,71 @@ char *VKtoKeyName(vk_type aVK, sc_type aSC, char *aBuf, int aBufSize)
 
 
 
+// The following are the g_key_to_vk and g_key_to_sc tables sorted by key name, which allows TextToVK() and
+// TextToSC() to use a binary search rather than a linear search through 100+ names.  This matters because
+// they're called for every hotkey at load-time, for every {Name} in Send, and by GetKeyState/KeyWait/etc.
+// The original tables aren't sorted in place because VKtoKeyName() and others rely on their order.
+static key_to_vk_type **sKeyToVKSorted = NULL;
+static key_to_sc_type **sKeyToSCSorted = NULL;
+
+static int SortKeyToVK(const void *a1, const void *a2)
+{
+	return stricmp((*(key_to_vk_type **)a1)->key_name, (*(key_to_vk_type **)a2)->key_name);
+}
+
+static int SortKeyToSC(const void *a1, const void *a2)
+{
+	return stricmp((*(key_to_sc_type **)a1)->key_name, (*(key_to_sc_type **)a2)->key_name);
+}
+
+static void InitKeyNameIndex()
+// If this fails due to lack of memory (very rare), the arrays remain NULL and callers fall back to linear search.
+// It's not fully thread-safe, but currently only the main thread calls TextToVK() and TextToSC().
+{
+	static bool sInitialized = false;
+	if (sInitialized)
+		return;
+	sInitialized = true;
+	int i;
+	if (sKeyToVKSorted = (key_to_vk_type **)malloc(g_key_to_vk_count * sizeof(key_to_vk_type *)))
+	{
+		for (i = 0; i < g_key_to_vk_count; ++i)
+			sKeyToVKSorted[i] = g_key_to_vk + i;
+		qsort((void *)sKeyToVKSorted, g_key_to_vk_count, sizeof(key_to_vk_type *), SortKeyToVK); // qsort() isn't stable, but that doesn't matter because the names that appear more than once (e.g. LShift) map to the same VK each time.
+	}
+	if (sKeyToSCSorted = (key_to_sc_type **)malloc(g_key_to_sc_count * sizeof(key_to_sc_type *)))
+	{
+		for (i = 0; i < g_key_to_sc_count; ++i)
+			sKeyToSCSorted[i] = g_key_to_sc + i;
+		qsort((void *)sKeyToSCSorted, g_key_to_sc_count, sizeof(key_to_sc_type *), SortKeyToSC);
+	}
+}
+
+
+
 sc_type TextToSC(char *aText)
 {
 	if (!*aText) return 0;
-	for (int i = 0; i < g_key_to_sc_count; ++i)
-		if (!stricmp(g_key_to_sc[i].key_name, aText))
-			return g_key_to_sc[i].sc;
+	InitKeyNameIndex();
+	if (sKeyToSCSorted)
+	{
+		int left, right, mid, result;  // left/right must be ints to allow them to go negative and detect underflow.
+		for (left = 0, right = g_key_to_sc_count - 1; left <= right;)
+		{
+			mid = (left + right) / 2;
+			result = stricmp(aText, sKeyToSCSorted[mid]->key_name);
+			if (result > 0)
+				left = mid + 1;
+			else if (result < 0)
+				right = mid - 1;
+			else // Match found.
+				return sKeyToSCSorted[mid]->sc;
+		}
+	}
+	else
+		for (int i = 0; i < g_key_to_sc_count; ++i)
+			if (!stricmp(g_key_to_sc[i].key_name, aText))
+				return g_key_to_sc[i].sc;
 	// Do this only after the above, in case any valid key names ever start with SC:
 	if (toupper(*aText) == 'S' && toupper(*(aText + 1)) == 'C')
 		return (sc_type)strtol(aText + 2, NULL, 16);  // Convert from hex.
@@ -3781,9 +3871,26 @@ vk_type TextToVK(char *aText, modLR_type *pModifiersLR, bool aExcludeThoseHandle
 	if (aAllowExplicitVK && toupper(aText[0]) == 'V' && toupper(aText[1]) == 'K')
 		return (vk_type)strtol(aText + 2, NULL, 16);  // Convert from hex.
 
-	for (int i = 0; i < g_key_to_vk_count; ++i)
-		if (!stricmp(g_key_to_vk[i].key_name, aText))
-			return g_key_to_vk[i].vk;
+	InitKeyNameIndex();
+	if (sKeyToVKSorted)
+	{
+		int left, right, mid, result;  // left/right must be ints to allow them to go negative and detect underflow.
+		for (left = 0, right = g_key_to_vk_count - 1; left <= right;)
+		{
+			mid = (left + right) / 2;
+			result = stricmp(aText, sKeyToVKSorted[mid]->key_name);
+			if (result > 0)
+				left = mid + 1;
+			else if (result < 0)
+				right = mid - 1;
+			else // Match found.
+				return sKeyToVKSorted[mid]->vk;
+		}
+	}
+	else
+		for (int i = 0; i < g_key_to_vk_count; ++i)
+			if (!stricmp(g_key_to_vk[i].key_name, aText))
+				return g_key_to_vk[i].vk;
 
 	if (aExcludeThoseHandledByScanCode)
 		return 0; // Zero is not a valid virtual key, so it should be a safe failure indicator.
@@ -3806,7 +3913,7 @@ vk_type CharToVKAndModifiers(char aChar, modLR_type *pModifiersLR, HKL aKeybdLay
 		return VK_RETURN;
 
 	// Otherwise:
-	SHORT mod_plus_vk = VkKeyScanEx(aChar, aKeybdLayout); // v1.0.44.03: Benchmark shows that VkKeyScanEx() is the same speed as VkKeyScan() when the layout has been pre-fetched.
+	SHORT mod_plus_vk = CachedVkKeyScan(aChar, aKeybdLayout); // v1.0.44.03: Benchmark shows that VkKeyScanEx() is the same speed as VkKeyScan() when the layout has been pre-fetched.
 	vk_type vk = LOBYTE(mod_plus_vk);
 	char keyscan_modifiers = HIBYTE(mod_plus_vk);
 	if (keyscan_modifiers == -1 && vk == (UCHAR)-1) // No translation could be made.
@@ -3870,6 +3977,10 @@ vk_type TextToSpecial(char *aText, UINT aTextLength, KeyEventTypes &aEventType,
 // Note that things like LShiftDown are not supported because: 1) they are rarely needed; and 2)
 // they can be down via "lshift down".
 {
+	// Every name below ends in "DOWN" or "UP", so rule out all other names (the vast majority of those
+	// passed by SendKeys()) without having to compare against each one:
+	if (aTextLength < 5 || toupper(aText[aTextLength - 1]) != 'N' && toupper(aText[aTextLength - 1]) != 'P')
+		return 0;
 	if (!strlicmp(aText, "ALTDOWN", aTextLength))
 	{
 		if (aUpdatePersistent)
@@ -175,6 +175,8 @@ struct CachedLayoutType
 {
 	HKL hkl;
 	ResultType has_altgr;
+	bool vk_scan_is_ready; // Whether vk_scan[] below has been filled in for this layout.
+	SHORT vk_scan[256]; // The result of VkKeyScanEx() for each char, indexed by (UCHAR)char.
 };
 
 struct key_to_vk_type // Map key names to virtual keys.
@@ -323,6 +325,7 @@ sc_type TextToSC(char *aText);
 vk_type TextToVK(char *aText, modLR_type *pModifiersLR = NULL, bool aExcludeThoseHandledByScanCode = false
 	, bool aAllowExplicitVK = true, HKL aKeybdLayout = GetKeyboardLayout(0));
 vk_type CharToVKAndModifiers(char aChar, modLR_type *pModifiersLR, HKL aKeybdLayout);
+SHORT CachedVkKeyScan(char aChar, HKL aKeybdLayout);
 vk_type TextToSpecial(char *aText, UINT aTextLength, KeyEventTypes &aEventTypem, modLR_type &aModifiersLR
 	, bool aUpdatePersistent);
 
@@ -162,6 +162,36 @@ unsigned long genrand_int32(void)
     return y;
 }
 
+// AutoHotkey: generates aCount random numbers on [0,0xffffffff]-interval into aBuf.  The numbers
+// are identical to those that aCount calls to genrand_int32() would have produced, but the state
+// vector is tempered a whole run at a time, which avoids the overhead of a call and a check of
+// "left" for every number.
+void genrand_int32_fill(unsigned long *aBuf, size_t aCount)
+{
+    unsigned long y;
+    size_t run;
+
+    while (aCount) {
+        if (--left == 0) 
+            next_state();
+        // The number at *next plus left-1 more can be taken before the state must be regenerated:
+        run = ((size_t)left < aCount) ? (size_t)left : aCount;
+        left -= (int)run - 1;
+        aCount -= run;
+        for (; run; --run) {
+            y = *next++;
+
+            // Tempering 
+            y ^= (y >> 11);
+            y ^= (y << 7) & 0x9d2c5680UL;
+            y ^= (y << 15) & 0xefc60000UL;
+            y ^= (y >> 18);
+
+            *aBuf++ = y;
+        }
+    }
+}
+
 // generates a random number on [0,0x7fffffff]-interval
 long genrand_int31(void)
 {
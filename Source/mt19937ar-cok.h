@@ -59,6 +59,10 @@ long genrand_int31(void);
 // generates a random number on [0,0xffffffff]-interval
 unsigned long genrand_int32(void);
 
+// AutoHotkey: fills aBuf with aCount random numbers on [0,0xffffffff]-interval (the same ones
+// that aCount calls to genrand_int32() would have produced).
+void genrand_int32_fill(unsigned long *aBuf, size_t aCount);
+
 // generates a random number on [0,1]-real-interval
 double genrand_real1(void);
 
@@ -42,9 +42,10 @@ Script::Script()
 	, mEndChar(0), mThisHotkeyModifiersLR(0)
 	, mNextClipboardViewer(NULL), mOnClipboardChangeIsRunning(false), mOnClipboardChangeLabel(NULL)
 	, mOnExitLabel(NULL), mExitReason(EXIT_NONE)
-	, mFirstLabel(NULL), mLastLabel(NULL)
-	, mFirstFunc(NULL), mLastFunc(NULL)
+	, mFirstLabel(NULL), mLastLabel(NULL), mLabel(NULL), mLabelCount(0), mLabelCountMax(0)
+	, mFirstFunc(NULL), mLastFunc(NULL), mFunc(NULL), mFuncCount(0), mFuncCountMax(0)
 	, mFirstTimer(NULL), mLastTimer(NULL), mTimerEnabledCount(0), mTimerCount(0)
+	, mTimerHeap(NULL), mTimerHeapCapacity(0)
 	, mFirstMenu(NULL), mLastMenu(NULL), mMenuCount(0)
 	, mVar(NULL), mVarCount(0), mVarCountMax(0), mLazyVar(NULL), mLazyVarCount(0)
 	, mCurrentFuncOpenBlockCount(0), mNextLineIsFunctionBody(false)
@@ -646,6 +647,7 @@ ResultType Script::AutoExecSection()
 
 		++g_nThreads;
 		ExecUntil_result = mFirstLine->ExecUntil(UNTIL_RETURN); // Might never return (e.g. infinite loop or ExitApp).
+		GuiType::EndThreadUpdates(); // See ResumeUnderlyingThread().
 		--g_nThreads;
 		// Our caller will take care of setting g_default properly.
 
@@ -870,6 +872,9 @@ void Script::TerminateApp(int aExitCode)
 		g_DestroyWindowCalled = true;
 		DestroyWindow(g_hWnd);
 	}
+	// Although the CRT would flush and close these files upon exit(), do it explicitly here so that
+	// nothing FileAppend buffered depends on that:
+	Line::FileAppendCacheClose();
 	Hotkey::AllDestructAndExit(aExitCode);
 }
 
@@ -1163,8 +1168,8 @@ ResultType Script::LoadIncludedFile(char *aFileSpec, bool aAllowDuplicateInclude
 
 #ifndef AUTOHOTKEYSC
 	// Future: might be best to put a stat() or GetFileAttributes() in here for better handling.
-	FILE *fp = fopen(aFileSpec, "r");
-	if (!fp)
+	ScriptFile script_file, *fp = &script_file; // Using "fp" helps consolidate the code below with the AUTOHOTKEYSC section.
+	if (!script_file.Open(aFileSpec))
 	{
 		if (aIgnoreLoadFailure)
 			return OK;
@@ -1180,13 +1185,8 @@ ResultType Script::LoadIncludedFile(char *aFileSpec, bool aAllowDuplicateInclude
 	// NOTE: To save code size, any UTF-8 BOM bytes at the beginning of a compiled script have already been
 	// stripped out by the script compiler.  Thus, there is no need to check for them in the AUTOHOTKEYSC
 	// section further below.
-	if (fgets(buf, 4, fp)) // Success (the fourth character is the terminator).
-	{
-		if (strcmp(buf, "﻿"))  // UTF-8 BOM marker is NOT present.
-			rewind(fp);  // Go back to the beginning so that the first three bytes aren't omitted during loading.
-			// The code size of rewind() has been checked and it seems very tiny.
-	}
-	//else file read error or EOF, let a later section handle it.
+	if (fp->mEnd - fp->mPos >= 3 && !memcmp(fp->mPos, "\xEF\xBB\xBF", 3)) // UTF-8 BOM marker is present.
+		fp->mPos += 3;
 
 	// This is done only after the file has been successfully opened in case aIgnoreLoadFailure==true:
 	if (source_file_index > 0)
@@ -2371,7 +2371,7 @@ continue_main_loop: // This method is used in lieu of "continue" for performance
 	free(script_buf); // AutoIt3: Close the archive and free the file in memory.
 	oRead.Close();    //
 #else
-	fclose(fp);
+	fp->Close();
 #endif
 	return OK;
 }
@@ -2387,11 +2387,67 @@ inline ResultType Script::CloseAndReturnFailFunc(HS_EXEArc_Read *fp, UCHAR *aBuf
 	return FAIL;
 }
 #else
-inline ResultType Script::CloseAndReturnFailFunc(FILE *fp)
+inline ResultType Script::CloseAndReturnFailFunc(ScriptFile *fp)
 {
-	fclose(fp);
+	fp->Close();
 	return FAIL;
 }
+
+
+
+ResultType ScriptFile::Open(char *aFileSpec)
+// Returns OK or FAIL.  Upon success, mPos and mEnd bound the entire contents of the file.
+{
+	Close(); // In case it was already open.
+	// Share mode is the same as that of fopen() for compatibility with editors that keep the file open:
+	mFile = CreateFile(aFileSpec, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING
+		, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (mFile == INVALID_HANDLE_VALUE)
+		return FAIL;
+	unsigned __int64 size = GetFileSize64(mFile);
+	if (size > 0x7FFFFFFF) // Failure (ULLONG_MAX) or too large to map into the address space.
+	{
+		Close();
+		return FAIL;
+	}
+	if (!size) // CreateFileMapping() fails for empty files, so treat it as a file with no lines.
+		return OK; // mPos and mEnd are both NULL, which GetLine() interprets as end-of-file.
+	if (   !(mMapping = CreateFileMapping(mFile, NULL, PAGE_READONLY, 0, 0, NULL))
+		|| !(mView = (char *)MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0))   )
+	{
+		Close();
+		return FAIL;
+	}
+	mPos = mView;
+	mEnd = mView + (size_t)size;
+	// For compatibility with the text-mode fopen() used by older versions, Ctrl+Z (ASCII 26) marks the end of the file:
+	char *eof_char = (char *)memchr(mView, 26, (size_t)size);
+	if (eof_char)
+		mEnd = eof_char;
+	return OK;
+}
+
+
+
+void ScriptFile::Close()
+{
+	if (mView)
+	{
+		UnmapViewOfFile(mView);
+		mView = NULL;
+	}
+	if (mMapping)
+	{
+		CloseHandle(mMapping);
+		mMapping = NULL;
+	}
+	if (mFile != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(mFile);
+		mFile = INVALID_HANDLE_VALUE;
+	}
+	mPos = mEnd = NULL;
+}
 #endif
 
 
@@ -2399,7 +2455,7 @@ inline ResultType Script::CloseAndReturnFailFunc(FILE *fp)
 #ifdef AUTOHOTKEYSC
 size_t Script::GetLine(char *aBuf, int aMaxCharsToRead, int aInContinuationSection, UCHAR *&aMemFile) // last param = reference to pointer
 #else
-size_t Script::GetLine(char *aBuf, int aMaxCharsToRead, int aInContinuationSection, FILE *fp)
+size_t Script::GetLine(char *aBuf, int aMaxCharsToRead, int aInContinuationSection, ScriptFile *fp)
 #endif
 {
 	size_t aBuf_length = 0;
@@ -2435,18 +2491,37 @@ size_t Script::GetLine(char *aBuf, int aMaxCharsToRead, int aInContinuationSecti
 #else
 	if (!aBuf || !fp) return -1;
 	if (aMaxCharsToRead < 1) return 0;
-	if (feof(fp)) return -1; // Previous call to this function probably already read the last line.
-	if (fgets(aBuf, aMaxCharsToRead, fp) == NULL) // end-of-file or error
+	if (fp->mPos >= fp->mEnd) // Previous call to this function probably already read the last line.
 	{
-		*aBuf = '\0';  // Reset since on error, contents added by fgets() are indeterminate.
+		*aBuf = '\0';
 		return -1;
 	}
-	aBuf_length = strlen(aBuf);
-	if (!aBuf_length)
-		return 0;
-	if (aBuf[aBuf_length-1] == '\n')
-		aBuf[--aBuf_length] = '\0';
-	if (aBuf[aBuf_length-1] == '\r')  // In case there are any, e.g. a Macintosh or Unix file?
+	// Like fgets(), read at most aMaxCharsToRead-1 chars.  If the line is longer than that, the rest of it
+	// is returned by the next call.  memchr() is used to find the end of the line because the CRT's
+	// version is much faster than examining one char at a time:
+	char *line_start = fp->mPos;
+	size_t max_length = aMaxCharsToRead - 1, space_remaining = fp->mEnd - line_start;
+	char *line_end = (char *)memchr(line_start, '\n', space_remaining < max_length ? space_remaining : max_length);
+	if (line_end) // Omit the newline char but move past it for the next call.
+	{
+		fp->mPos = line_end + 1;
+		if (line_end > line_start && line_end[-1] == '\r') // Omit the CR of each CRLF like text-mode fgets() did.
+			--line_end;
+	}
+	else // The line is too long to fit or is the last line in the file.
+	{
+		fp->mPos = line_end = line_start + (space_remaining < max_length ? space_remaining : max_length);
+		// Text-mode fgets() counted each CRLF as a single char, so a line that fits only when its CRLF
+		// is counted that way ends with a '\r' here.  Consume the '\n' too; otherwise the next call would
+		// return a spurious empty line (the CR itself is removed below):
+		if (line_end > line_start && line_end[-1] == '\r' && line_end < fp->mEnd && *line_end == '\n')
+			++fp->mPos;
+	}
+	aBuf_length = line_end - line_start;
+	memcpy(aBuf, line_start, aBuf_length);
+	aBuf[aBuf_length] = '\0';
+	aBuf_length = strlen(aBuf); // In case the line contains a binary zero, which also terminated the line with fgets().
+	if (aBuf_length && aBuf[aBuf_length-1] == '\r')  // In case there are any, e.g. a Macintosh or Unix file?
 		aBuf[--aBuf_length] = '\0';
 #endif
 
@@ -3001,6 +3076,7 @@ inline ResultType Script::IsDirective(char *aBuf)
 void ScriptTimer::Disable()
 {
 	mEnabled = false;
+	g_script.TimerHeapRemove(this);
 	--g_script.mTimerEnabledCount;
 	if (!g_script.mTimerEnabledCount && !g_nLayersNeedingTimer && !Hotkey::sJoyHotkeyCount)
 		KILL_MAIN_TIMER
@@ -3035,7 +3111,19 @@ ResultType Script::UpdateOrCreateTimer(Label *aLabel, char *aPeriod, char *aPrio
 	bool timer_existed = (timer != NULL);
 	if (!timer_existed)  // Create it.
 	{
-		if (   !(timer = new ScriptTimer(aLabel))   )
+		if (mTimerCount >= mTimerHeapCapacity)
+		{
+			// Expand the heap now so that it always has room for every timer, which allows enabling a timer
+			// (here or anywhere else) to insert it without having to check for failure.  Use a temp var.
+			// because realloc() returns NULL on failure but leaves original block allocated.
+			UINT new_capacity = mTimerHeapCapacity ? mTimerHeapCapacity * 2 : 16;
+			ScriptTimer **realloc_temp = (ScriptTimer **)realloc(mTimerHeap, new_capacity * sizeof(ScriptTimer *)); // If passed NULL, realloc() will do a malloc().
+			if (!realloc_temp)
+				return ScriptError(ERR_OUTOFMEM);
+			mTimerHeap = realloc_temp;
+			mTimerHeapCapacity = new_capacity;
+		}
+		if (   !(timer = new ScriptTimer(aLabel, mTimerCount))   )
 			return ScriptError(ERR_OUTOFMEM);
 		if (!mFirstTimer)
 			mFirstTimer = mLastTimer = timer;
@@ -3054,6 +3142,7 @@ ResultType Script::UpdateOrCreateTimer(Label *aLabel, char *aPeriod, char *aPrio
 		if (!(timer_existed && aUpdatePriorityOnly))
 		{
 			timer->mEnabled = true;
+			TimerHeapInsert(timer); // Its position is corrected further below, once its period and start time are known.
 			++mTimerEnabledCount;
 			SET_MAIN_TIMER  // Ensure the API timer is always running when there is at least one enabled timed subroutine.
 		}
@@ -3085,7 +3174,10 @@ ResultType Script::UpdateOrCreateTimer(Label *aLabel, char *aPeriod, char *aPrio
 		// flexible, e.g. a user might want to create a timer that is triggered 5 seconds from now.
 		// In such a case, we don't want the timer's first triggering to occur immediately.
 		// Instead, we want it to occur only when the full 5 seconds have elapsed:
-		timer->mTimeLastRun = GetTickCount();
+		timer->mTimeLastRun = GetTickCount64Ex();
+
+	if (timer->mEnabled) // Its due-time might have changed above, so move it to its new position in the heap.
+		TimerHeapUpdate(timer);
 
     // Below is obsolete, see above for why:
 	// We don't have to kill or set the main timer because the only way this function is called
@@ -3098,18 +3190,137 @@ ResultType Script::UpdateOrCreateTimer(Label *aLabel, char *aPeriod, char *aPrio
 
 
 
+void Script::TimerHeapInsert(ScriptTimer *aTimer)
+// Caller must ensure aTimer isn't already in the heap.  There is always room because the heap is
+// expanded whenever a new timer is created (see UpdateOrCreateTimer()).
+{
+	aTimer->mHeapIndex = mTimerEnabledCount; // Callers increment mTimerEnabledCount only after calling us.
+	mTimerHeap[aTimer->mHeapIndex] = aTimer;
+	TimerHeapUpdate(aTimer);
+}
+
+
+
+void Script::TimerHeapRemove(ScriptTimer *aTimer)
+// Caller must decrement mTimerEnabledCount only after calling us.
+{
+	int i = aTimer->mHeapIndex;
+	if (i < 0) // Not in the heap.
+		return;
+	aTimer->mHeapIndex = -1;
+	int last = mTimerEnabledCount - 1;
+	if (i == last) // It was the last item, so nothing else needs to be moved.
+		return;
+	// Fill the hole with the heap's last item, then sift that item up or down to its proper place.
+	// mTimerEnabledCount is temporarily decremented so that TimerHeapUpdate() disregards the old last slot.
+	ScriptTimer *moved = mTimerHeap[last];
+	mTimerHeap[i] = moved;
+	moved->mHeapIndex = i;
+	--mTimerEnabledCount;
+	TimerHeapUpdate(moved);
+	++mTimerEnabledCount;
+}
+
+
+
+void Script::TimerHeapUpdate(ScriptTimer *aTimer)
+// Restores the heap order after aTimer's DueTime() has changed in either direction.
+{
+	int i = aTimer->mHeapIndex, child, parent, count = (int)mTimerEnabledCount;
+	if (i >= count) // It's being inserted (see TimerHeapInsert()), so it's the item just beyond the current end.
+		++count;
+	unsigned __int64 due = aTimer->DueTime();
+	// Sift up:
+	for (; i > 0; i = parent)
+	{
+		parent = (i - 1) / 2;
+		if (mTimerHeap[parent]->DueTime() <= due)
+			break;
+		mTimerHeap[i] = mTimerHeap[parent];
+		mTimerHeap[i]->mHeapIndex = i;
+	}
+	// Sift down (has no effect if the above moved it up):
+	for (;;)
+	{
+		child = 2 * i + 1;
+		if (child >= count)
+			break;
+		if (child + 1 < count && mTimerHeap[child + 1]->DueTime() < mTimerHeap[child]->DueTime())
+			++child; // Use the earlier of the two children.
+		if (due <= mTimerHeap[child]->DueTime())
+			break;
+		mTimerHeap[i] = mTimerHeap[child];
+		mTimerHeap[i]->mHeapIndex = i;
+		i = child;
+	}
+	mTimerHeap[i] = aTimer;
+	aTimer->mHeapIndex = i;
+}
+
+
+
+int Script::GetDueTimers(ScriptTimer *aDueTimer[], int aMaxTimers, unsigned __int64 aTickNow, int aMinPriority)
+// Stores in aDueTimer up to aMaxTimers enabled timers whose due-time has arrived, sorted by their position
+// in the linked list (so that simultaneously-due timers are launched in the same order as in older versions).
+// Returns the number of timers stored.  Due timers that can't be launched right now (because they're
+// already running or their priority is lower than aMinPriority) are omitted.  Since such timers aren't
+// rescheduled, they stay at the top of the heap, so counting them toward aMaxTimers could starve other
+// due timers indefinitely.  Since every subtree of a heap contains only items due no earlier
+// than its root, the search skips entire subtrees that aren't due, so the cost is proportional to the
+// number of due timers rather than the total number of timers.
+{
+	int count = 0, stack[64], stack_count = 0, i, j; // 64 levels is far beyond the depth of any possible heap.
+	if (mTimerEnabledCount)
+		stack[stack_count++] = 0;
+	while (stack_count && count < aMaxTimers)
+	{
+		i = stack[--stack_count];
+		ScriptTimer *timer = mTimerHeap[i];
+		if (timer->DueTime() > aTickNow) // Neither it nor any of its descendants is due.
+			continue;
+		if (!timer->mExistingThreads && timer->mPriority >= aMinPriority) // It can be launched (but its descendants are searched either way).
+		{
+			// Insertion sort is used because the number of due timers is usually very small:
+			for (j = count++; j > 0 && aDueTimer[j - 1]->mOrdinal > timer->mOrdinal; --j)
+				aDueTimer[j] = aDueTimer[j - 1];
+			aDueTimer[j] = timer;
+		}
+		if ((UINT)(2 * i + 2) < mTimerEnabledCount)
+			stack[stack_count++] = 2 * i + 2;
+		if ((UINT)(2 * i + 1) < mTimerEnabledCount)
+			stack[stack_count++] = 2 * i + 1;
+	}
+	return count;
+}
+
+
+
 Label *Script::FindLabel(char *aLabelName)
 // Returns the first label whose name matches aLabelName, or NULL if not found.
 // v1.0.42: Since duplicates labels are now possible (to support #IfWin variants of a particular
 // hotkey or hotstring), callers must be aware that only the first match is returned.
-// This helps performance by requiring on average only half the labels to be searched before
-// a match is found.
+// Since every Goto/Gosub/hotkey label is resolved this way at load-time (and AddLabel() uses it to
+// check for duplicates), a binary search of the sorted mLabel array is used rather than a linear
+// search of the linked list, which would make loading a script with many labels O(n^2).
 {
 	if (!aLabelName || !*aLabelName) return NULL;
-	for (Label *label = mFirstLabel; label != NULL; label = label->mNextLabel)
-		if (!stricmp(label->mName, aLabelName)) // lstrcmpi() is not used: 1) avoids breaking exisitng scripts; 2) provides consistent behavior across multiple locales; 3) performance.
-			return label; // Match found.
-	return NULL; // No match found.
+	// Binary search for the leftmost match, which is the one added first (see AddLabel()):
+	int left, right, mid, result;  // left/right must be ints to allow them to go negative and detect underflow.
+	Label *found = NULL;
+	for (left = 0, right = mLabelCount - 1; left <= right;)
+	{
+		mid = (left + right) / 2;
+		result = stricmp(aLabelName, mLabel[mid]->mName); // lstrcmpi() is not used: 1) avoids breaking exisitng scripts; 2) provides consistent behavior across multiple locales; 3) performance.
+		if (result > 0)
+			left = mid + 1;
+		else
+		{
+			if (!result) // Match found, but keep searching to the left for an earlier duplicate.
+				found = mLabel[mid];
+			right = mid - 1;
+		}
+	}
+	return found;
 }
 
 
@@ -3129,9 +3340,33 @@ ResultType Script::AddLabel(char *aLabelName, bool aAllowDupe)
 	char *new_name = SimpleHeap::Malloc(aLabelName);
 	if (!new_name)
 		return FAIL;  // It already displayed the error for us.
+	if (mLabelCount >= mLabelCountMax) // Expand the sorted array (see FindLabel()).
+	{
+		int new_max = mLabelCountMax ? mLabelCountMax * 2 : 256;
+		// Use a temp var. because realloc() returns NULL on failure but leaves original block allocated.
+		Label **realloc_temp = (Label **)realloc(mLabel, new_max * sizeof(Label *)); // If passed NULL, realloc() will do a malloc().
+		if (!realloc_temp)
+			return ScriptError(ERR_OUTOFMEM);
+		mLabel = realloc_temp;
+		mLabelCountMax = new_max;
+	}
 	Label *the_new_label = new Label(new_name); // Pass it the dynamic memory area we created.
 	if (the_new_label == NULL)
 		return ScriptError(ERR_OUTOFMEM);
+	// Insert it after any existing labels of the same name so that FindLabel() continues to find the first one:
+	int left, right, mid;
+	for (left = 0, right = mLabelCount - 1; left <= right;)
+	{
+		mid = (left + right) / 2;
+		if (stricmp(new_name, mLabel[mid]->mName) >= 0)
+			left = mid + 1;
+		else
+			right = mid - 1;
+	}
+	if (left < mLabelCount)
+		memmove(mLabel + left + 1, mLabel + left, (mLabelCount - left) * sizeof(Label *));
+	mLabel[left] = the_new_label;
+	++mLabelCount;
 	the_new_label->mPrevLabel = mLastLabel;  // Whether NULL or not.
 	if (mFirstLabel == NULL)
 		mFirstLabel = the_new_label;
@@ -5452,6 +5687,8 @@ ResultType Script::AddLine(ActionTypeType aActionType, char *aArg[], ArgCountTyp
 			case GUI_CMD_DESTROY:
 			case GUI_CMD_DEFAULT:
 			case GUI_CMD_OPTIONS:
+			case GUI_CMD_BEGINUPDATE:
+			case GUI_CMD_ENDUPDATE:
 				if (aArgc > 1)
 					return ScriptError("Parameter #2 and beyond should be omitted in this case.", new_raw_arg2);
 				break;
@@ -6725,12 +6962,92 @@ ResultType Script::DefineFunc(char *aBuf, Var *aFuncExceptionVar[])
 
 
 #ifndef AUTOHOTKEYSC
+#define FUNC_LIB_EXT ".ahk"
+#define FUNC_LIB_EXT_LENGTH 4
+
 struct FuncLibrary
 {
 	char *path;
 	DWORD length;
+	// Sorted array of the names of the files in this library (see FuncLibraryIndex()), which allows each
+	// candidate filename to be checked via binary search rather than a call to GetFileAttributes():
+	char **file;
+	int file_count;
+	bool is_indexed; // False if the above couldn't be built, in which case each file is probed individually.
 };
 
+int FuncLibraryCompare(const void *a1, const void *a2)
+{
+	return stricmp(*(char **)a1, *(char **)a2); // Case-insensitive like the file system (for ASCII, at least).
+}
+
+void FuncLibraryIndex(FuncLibrary &aLib)
+// Scans aLib's directory once and stores the names of all its .ahk files, so that resolving hundreds of
+// library functions costs a single directory scan rather than one file system probe per function.
+{
+	aLib.file = NULL;
+	aLib.file_count = 0;
+	aLib.is_indexed = false; // Set default.
+	if (aLib.length >= MAX_PATH - 5) // No room to append "*.ahk".
+		return;
+	strcpy(aLib.path + aLib.length, "*" FUNC_LIB_EXT);
+	WIN32_FIND_DATA new_file;
+	HANDLE file_search = FindFirstFile(aLib.path, &new_file);
+	aLib.path[aLib.length] = '\0'; // Undo the above.
+	if (file_search == INVALID_HANDLE_VALUE)
+	{
+		aLib.is_indexed = (GetLastError() == ERROR_FILE_NOT_FOUND); // The library is empty, so there's no need to probe it.
+		return;
+	}
+	int i, file_count_max = 0;
+	char **realloc_temp, *name[2];
+	do
+	{
+		if (new_file.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) // GetFileAttributes() wouldn't accept these either.
+			continue;
+		// Add both the long name and its 8.3 alias (if any) because GetFileAttributes() accepts either:
+		name[0] = new_file.cFileName;
+		name[1] = new_file.cAlternateFileName;
+		for (i = 0; i < 2 && *name[i]; ++i)
+		{
+			if (aLib.file_count >= file_count_max) // Expand the array.
+			{
+				file_count_max = file_count_max ? file_count_max * 2 : 256;
+				// Use a temp var. because realloc() returns NULL on failure but leaves original block allocated.
+				if (   !(realloc_temp = (char **)realloc(aLib.file, file_count_max * sizeof(char *)))   )
+					break;
+				aLib.file = realloc_temp;
+			}
+			if (   !(aLib.file[aLib.file_count] = SimpleHeap::Malloc(name[i]))   )
+				break;
+			++aLib.file_count;
+		}
+		if (i < 2 && *name[i]) // Out of memory (very rare), so fall back to probing each file.
+		{
+			FindClose(file_search);
+			free(aLib.file);
+			aLib.file = NULL;
+			aLib.file_count = 0;
+			return;
+		}
+	} while (FindNextFile(file_search, &new_file));
+	FindClose(file_search);
+	qsort((void *)aLib.file, aLib.file_count, sizeof(char *), FuncLibraryCompare);
+	aLib.is_indexed = true;
+}
+
+bool FuncLibraryMightHaveFile(FuncLibrary &aLib, char *aFilename)
+// Returns false only if aFilename definitely doesn't exist in aLib.  Otherwise, caller should
+// verify its existence with GetFileAttributes().
+{
+	if (!aLib.is_indexed)
+		return true;
+	for (char *cp = aFilename; *cp; ++cp)
+		if ((UCHAR)*cp > 127) // The file system's case-insensitivity for such chars might differ from stricmp().
+			return true;
+	return bsearch(&aFilename, aLib.file, aLib.file_count, sizeof(char *), FuncLibraryCompare) != NULL;
+}
+
 Func *Script::FindFuncInLibrary(char *aFuncName, size_t aFuncNameLength, bool &aErrorWasShown)
 // Caller must ensure that aFuncName doesn't already exist as a defined function.
 // If aFuncNameLength is 0, the entire length of aFuncName is used.
@@ -6741,8 +7058,6 @@ Func *Script::FindFuncInLibrary(char *aFuncName, size_t aFuncNameLength, bool &a
 	char *char_after_last_backslash, *terminate_here;
 	DWORD attr;
 
-	#define FUNC_LIB_EXT ".ahk"
-	#define FUNC_LIB_EXT_LENGTH 4
 	#define FUNC_USER_LIB "\\AutoHotkey\\Lib\\" // Needs leading and trailing backslash.
 	#define FUNC_USER_LIB_LENGTH 16
 	#define FUNC_STD_LIB "Lib\\" // Needs trailing but not leading backslash.
@@ -6795,6 +7110,8 @@ Func *Script::FindFuncInLibrary(char *aFuncName, size_t aFuncNameLength, bool &a
 				*sLib[i].path = '\0'; // Mark this library as disabled.
 				sLib[i].length = 0;   //
 			}
+			else
+				FuncLibraryIndex(sLib[i]);
 		}
 	}
 	// Above must ensure that all sLib[].path elements are non-NULL (but they can be "" to indicate "no library").
@@ -6818,6 +7135,8 @@ Func *Script::FindFuncInLibrary(char *aFuncName, size_t aFuncNameLength, bool &a
 			dest = (char *)memcpy(sLib[i].path + sLib[i].length, naked_filename, naked_filename_length); // Append the filename to the library path.
 			strcpy(dest + naked_filename_length, FUNC_LIB_EXT); // Append the file extension.
 
+			if (!FuncLibraryMightHaveFile(sLib[i], dest)) // For performance, consult the index before probing the file system.
+				continue;
 			attr = GetFileAttributes(sLib[i].path); // Testing confirms that GetFileAttributes() doesn't support wildcards; which is good because we want filenames containing question marks to be "not found" rather than being treated as a match-pattern.
 			if (attr == 0xFFFFFFFF || (attr & FILE_ATTRIBUTE_DIRECTORY)) // File doesn't exist or it's a directory. Relies on short-circuit boolean order.
 				continue;
@@ -6908,10 +7227,20 @@ Func *Script::FindFunc(char *aFuncName, size_t aFuncNameLength)
 	char func_name[MAX_VAR_NAME_LENGTH + 1];
 	strlcpy(func_name, aFuncName, aFuncNameLength + 1);  // +1 to convert length to size.
 
-	Func *pfunc;
-	for (pfunc = mFirstFunc; pfunc; pfunc = pfunc->mNextFunc)
-		if (!stricmp(func_name, pfunc->mName)) // lstrcmpi() is not used: 1) avoids breaking exisitng scripts; 2) provides consistent behavior across multiple locales; 3) performance.
-			return pfunc; // Match found.
+	// Binary search.  This is much faster than the linear search of the linked list that older versions
+	// used, since large scripts resolve thousands of function calls against hundreds of functions:
+	int left, right, mid, result;  // left/right must be ints to allow them to go negative and detect underflow.
+	for (left = 0, right = mFuncCount - 1; left <= right;)
+	{
+		mid = (left + right) / 2;
+		result = stricmp(func_name, mFunc[mid]->mName); // lstrcmpi() is not used: 1) avoids breaking exisitng scripts; 2) provides consistent behavior across multiple locales; 3) performance.
+		if (result > 0)
+			left = mid + 1;
+		else if (result < 0)
+			right = mid - 1;
+		else // Match found.
+			return mFunc[mid];
+	}
 
 	// Since above didn't return, there is no match.  See if it's a built-in function that hasn't yet
 	// been added to the function list.
@@ -6960,6 +7289,11 @@ Func *Script::FindFunc(char *aFuncName, size_t aFuncNameLength)
 			min_params = 2;
 			max_params = 10000; // An arbitrarily high limit that will never realistically be reached.
 		}
+		else if (!stricmp(suffix, "AddMany"))
+		{
+			bif = BIF_LV_AddMany;
+			max_params = 2; // Leave min at 1.
+		}
 		else if (!stricmp(suffix, "Delete"))
 		{
 			bif = BIF_LV_Delete;
@@ -7002,6 +7336,11 @@ Func *Script::FindFunc(char *aFuncName, size_t aFuncNameLength)
 			bif = BIF_TV_AddModifyDelete;
 			max_params = 3; // One-parameter mode is "select specified item".
 		}
+		else if (!stricmp(suffix, "AddMany"))
+		{
+			bif = BIF_TV_AddMany;
+			max_params = 3; // Leave min at its default of 1.
+		}
 		else if (!stricmp(suffix, "Delete"))
 		{
 			bif = BIF_TV_AddModifyDelete;
@@ -7128,6 +7467,12 @@ Func *Script::FindFunc(char *aFuncName, size_t aFuncNameLength)
 		bif = BIF_VarSetCapacity;
 		max_params = 3;
 	}
+	else if (!stricmp(func_name, "RandomFill"))
+	{
+		bif = BIF_RandomFill;
+		min_params = 2;
+		max_params = 4;
+	}
 	else if (!stricmp(func_name, "FileExist"))
 		bif = BIF_FileExist;
 	else if (!stricmp(func_name, "WinExist") || !stricmp(func_name, "WinActive"))
@@ -7244,6 +7589,20 @@ Func *Script::AddFunc(char *aFuncName, size_t aFuncNameLength, bool aIsBuiltIn)
 		// to bother varying the error message to include ERR_ABORT if this occurs during runtime.
 		return NULL;
 
+	if (mFuncCount >= mFuncCountMax) // Expand the sorted array (see FindFunc()).
+	{
+		int new_max = mFuncCountMax ? mFuncCountMax * 2 : 256;
+		// Use a temp var. because realloc() returns NULL on failure but leaves original block allocated.
+		Func **realloc_temp = (Func **)realloc(mFunc, new_max * sizeof(Func *)); // If passed NULL, realloc() will do a malloc().
+		if (!realloc_temp)
+		{
+			ScriptError(ERR_OUTOFMEM);
+			return NULL;
+		}
+		mFunc = realloc_temp;
+		mFuncCountMax = new_max;
+	}
+
 	Func *the_new_func = new Func(new_name, aIsBuiltIn);
 	if (!the_new_func)
 	{
@@ -7251,6 +7610,21 @@ Func *Script::AddFunc(char *aFuncName, size_t aFuncNameLength, bool aIsBuiltIn)
 		return NULL;
 	}
 
+	// Find the position at which to insert it to keep the array sorted (caller has ensured it's not a duplicate):
+	int left, right, mid;
+	for (left = 0, right = mFuncCount - 1; left <= right;)
+	{
+		mid = (left + right) / 2;
+		if (stricmp(new_name, mFunc[mid]->mName) > 0)
+			left = mid + 1;
+		else
+			right = mid - 1;
+	}
+	if (left < mFuncCount)
+		memmove(mFunc + left + 1, mFunc + left, (mFuncCount - left) * sizeof(Func *));
+	mFunc[left] = the_new_func;
+	++mFuncCount;
+
 	// v1.0.47: The following ISN'T done because it would slow down commonly used functions. This is because
 	// commonly-called functions like InStr() tend to be added first (since they appear so often throughout
 	// the script); thus subsequent lookups are fast if they are kept at the beginning of the list rather
@@ -7261,6 +7635,7 @@ Func *Script::AddFunc(char *aFuncName, size_t aFuncNameLength, bool aIsBuiltIn)
 	// of functions.  This is because functions brought in dynamically from a library will then be at the
 	// beginning of the list, which allows the function lookup that immediately follows library-loading to
 	// find a match almost immediately.
+	// UPDATE: FindFunc() now uses the sorted mFunc array, so the order of this list no longer affects lookups.
 	if (!mFirstFunc) // The list is empty, so this will be the first and last item.
 		mFirstFunc = the_new_func;
 	else
@@ -10450,6 +10825,8 @@ ResultType Line::ExecUntil(ExecUntilMode aMode, char **apReturnValue, Line **apJ
 				break;
 			case ATTR_LOOP_READ_FILE:
 				FILE *read_file;
+				if (sFileAppendCacheCount) // In case FileAppend recently wrote to the file to be read.
+					FileAppendCacheClose();
 				if (*ARG2 && (read_file = fopen(ARG2, "r"))) // v1.0.47: Added check for "" to avoid debug-assertion failure while in debug mode (maybe it's bad to to open file "" in release mode too).
 				{
 					result = line->PerformLoopReadFile(apReturnValue, continue_main_loop, jump_to_line, read_file, ARG3);
@@ -10463,6 +10840,8 @@ ResultType Line::ExecUntil(ExecUntilMode aMode, char **apReturnValue, Line **apJ
 					result = OK;
 				break;
 			case ATTR_LOOP_FILEPATTERN:
+				if (sFileAppendCacheCount) // So that A_LoopFileSize and such are up-to-date, and so that the files can be moved or deleted.
+					FileAppendCacheClose();
 				result = line->PerformLoopFilePattern(apReturnValue, continue_main_loop, jump_to_line, file_loop_mode
 					, recurse_subfolders, ARG1);
 				break;
@@ -11031,10 +11410,15 @@ ResultType Line::EvaluateCondition() // __forceinline on this reduces benchmarks
 		break;
 
 	case ACT_IFEXIST:
-		if_condition = DoesFilePatternExist(ARG1);
-		break;
 	case ACT_IFNOTEXIST:
-		if_condition = !DoesFilePatternExist(ARG1);
+		// Close any files FileAppend is holding open, since a script that checks for a file is likely to
+		// operate on it next (e.g. via DllCall), and the directory entry of a file that's open for writing
+		// might not yet reflect its new size:
+		if (sFileAppendCacheCount)
+			FileAppendCacheClose();
+		if_condition = DoesFilePatternExist(ARG1);
+		if (mActionType == ACT_IFNOTEXIST)
+			if_condition = !if_condition;
 		break;
 
 	case ACT_IFMSGBOX:
@@ -11208,7 +11592,7 @@ ResultType Line::PerformLoopFilePattern(char **apReturnValue, bool &aContinueMai
 	// loop is a file-loop:
 	BOOL file_found;
 	WIN32_FIND_DATA new_current_file;
-	HANDLE file_search = FindFirstFile(aFilePattern, &new_current_file);
+	HANDLE file_search = FindFirstFileBatched(aFilePattern, new_current_file, aFileLoopMode == FILE_LOOP_FOLDERS_ONLY);
 	for ( file_found = (file_search != INVALID_HANDLE_VALUE) // Convert FindFirst's return value into a boolean so that it's compatible with with FindNext's.
 		; file_found && FileIsFilteredOut(new_current_file, aFileLoopMode, file_path, file_path_length)
 		; file_found = FindNextFile(file_search, &new_current_file));
@@ -11280,7 +11664,7 @@ ResultType Line::PerformLoopFilePattern(char **apReturnValue, bool &aContinueMai
 	char *append_pos = file_path + file_path_length;
 	strcpy(append_pos, "*.*"); // Above has already verified that no overflow is possible.
 
-	file_search = FindFirstFile(file_path, &new_current_file);
+	file_search = FindFirstFileBatched(file_path, new_current_file, true); // Only folders are of interest here.
 	if (file_search == INVALID_HANDLE_VALUE)
 		return OK; // Nothing more to do.
 	// Otherwise, recurse into any subdirectories found inside this parent directory.
@@ -11328,18 +11712,20 @@ ResultType Line::PerformLoopFilePattern(char **apReturnValue, bool &aContinueMai
 
 
 ResultType Line::PerformLoopReg(char **apReturnValue, bool &aContinueMainLoop, Line *&aJumpToLine, FileLoopModeType aFileLoopMode
-	, bool aRecurseSubfolders, HKEY aRootKeyType, HKEY aRootKey, char *aRegSubkey)
+	, bool aRecurseSubfolders, HKEY aRootKeyType, HKEY aRootKey, char *aRegSubkey, HKEY aRegKey)
 // aRootKeyType is the type of root key, independent of whether it's local or remote.
 // This is used because there's no easy way to determine which root key a remote HKEY
 // refers to.
+// aRegKey, if non-NULL, is a handle to aRegSubkey that the caller has already opened (used
+// when recursing); this function takes ownership of it and closes it before returning.
 {
 	RegItemStruct reg_item(aRootKeyType, aRootKey, aRegSubkey);
-	HKEY hRegKey;
+	HKEY hRegKey = aRegKey;
 
 	// Open the specified subkey.  Be sure to only open with the minimum permission level so that
 	// the keys & values can be deleted or written to (though I'm not sure this would be an issue
 	// in most cases):
-	if (RegOpenKeyEx(reg_item.root_key, reg_item.subkey, 0, KEY_QUERY_VALUE | KEY_ENUMERATE_SUB_KEYS, &hRegKey) != ERROR_SUCCESS)
+	if (!hRegKey && RegOpenKeyEx(reg_item.root_key, reg_item.subkey, 0, KEY_QUERY_VALUE | KEY_ENUMERATE_SUB_KEYS, &hRegKey) != ERROR_SUCCESS)
 		return OK;
 
 	// Get the count of how many values and subkeys are contained in this parent key:
@@ -11420,6 +11806,7 @@ ResultType Line::PerformLoopReg(char **apReturnValue, bool &aContinueMainLoop, L
 	// at least in some cases:
 	reg_item.InitForSubkeys();
 	char subkey_full_path[MAX_REG_ITEM_SIZE]; // But doesn't include the root key name, which is not only by design but testing shows that if it did, the length could go over MAX_REG_ITEM_SIZE.
+	HKEY hSubkey;
 	for (i = count_subkeys - 1;; --i) // Will have zero iterations if there are no subkeys.
 	{
 		// Don't use CONTINUE in loops such as this due to the loop-ending condition being explicitly
@@ -11437,9 +11824,17 @@ ResultType Line::PerformLoopReg(char **apReturnValue, bool &aContinueMainLoop, L
 				// (fixed for v1.0.17):
 				snprintf(subkey_full_path, sizeof(subkey_full_path), "%s%s%s", reg_item.subkey
 					, *reg_item.subkey ? "\\" : "", reg_item.name);
-				// This section is very similar to the one in PerformLoop(), so see it for comments:
-				result = PerformLoopReg(apReturnValue, aContinueMainLoop, aJumpToLine, aFileLoopMode
-					, aRecurseSubfolders, aRootKeyType, aRootKey, subkey_full_path);
+				// Open the subkey relative to its parent rather than by its full path from the root key.
+				// This avoids having the registry re-parse every ancestor of the subkey on each call,
+				// which adds up during deep recursion (e.g. through HKLM\Software).  If the loop body
+				// deleted or renamed the subkey above, the open fails and the subkey is skipped just as
+				// it was when the recursive call opened it by its full path:
+				if (RegOpenKeyEx(hRegKey, reg_item.name, 0, KEY_QUERY_VALUE | KEY_ENUMERATE_SUB_KEYS, &hSubkey) == ERROR_SUCCESS)
+					// This section is very similar to the one in PerformLoop(), so see it for comments:
+					result = PerformLoopReg(apReturnValue, aContinueMainLoop, aJumpToLine, aFileLoopMode
+						, aRecurseSubfolders, aRootKeyType, aRootKey, subkey_full_path, hSubkey);
+				else
+					result = OK;
 				if (result != OK && result != LOOP_CONTINUE) // i.e. result == LOOP_BREAK || result == EARLY_RETURN || result == EARLY_EXIT || result == FAIL)
 				{
 					RegCloseKey(hRegKey);
@@ -11796,6 +12191,11 @@ __forceinline ResultType Line::Perform() // As of 2/9/2009, __forceinline() redu
 	// are taken out or added to the param list:
 	//if (nArgs < g_act[mActionType].MinParams) ...
 
+	// Any files FileAppend is holding open must be closed prior to commands that might operate upon
+	// them.  Otherwise, the command might see an incomplete file or fail due to the file being in use:
+	if (sFileAppendCacheCount && ACT_CLOSES_FILE_APPEND_CACHE(mActionType))
+		FileAppendCacheClose();
+
 	switch (mActionType)
 	{
 	case ACT_ASSIGN:
@@ -11916,18 +12316,18 @@ __forceinline ResultType Line::Perform() // As of 2/9/2009, __forceinline() redu
 		// Use double to support a floating point value for days, hours, minutes, etc:
 		double nUnits; // Declaring separate from initializing avoids compiler warning when not inside a block.
 		nUnits = ARG2_AS_DOUBLE;
-		FILETIME ft, ftNowUTC;
+		// The date-time is held as 10ths of a microsecond since 1601 (the units of the FILETIME struct),
+		// but the conversions to and from YYYYMMDD are done arithmetically rather than via the OS:
+		__int64 ticks;
 		if (*output_var->Contents())
 		{
-			if (!YYYYMMDDToFileTime(output_var->Contents(), ft))
+			if (!YYYYMMDDToSeconds(output_var->Contents(), ticks))
 				return output_var->Assign(""); // Set to blank to indicate the problem.
+			ticks *= 10000000;
 		}
 		else // The output variable is currently blank, so substitute the current time for it.
-		{
-			GetSystemTimeAsFileTime(&ftNowUTC);
-			FileTimeToLocalFileTime(&ftNowUTC, &ft);  // Convert UTC to local time.
-		}
-		// Convert to 10ths of a microsecond (the units of the FILETIME struct):
+			ticks = GetLocalTimeTicks();
+		// Convert to 10ths of a microsecond:
 		switch (toupper(*ARG3))
 		{
 		case 'S': // Seconds
@@ -11943,16 +12343,11 @@ __forceinline ResultType Line::Perform() // As of 2/9/2009, __forceinline() redu
 			nUnits *= ((double)10000000 * 60 * 60 * 24);
 			break;
 		}
-		// Convert ft struct to a 64-bit variable (maybe there's some way to avoid these conversions):
-		ULARGE_INTEGER ul;
-		ul.LowPart = ft.dwLowDateTime;
-		ul.HighPart = ft.dwHighDateTime;
 		// Add the specified amount of time to the result value:
-		ul.QuadPart += (__int64)nUnits;  // Seems ok to cast/truncate in light of the *=10000000 above.
-		// Convert back into ft struct:
-		ft.dwLowDateTime = ul.LowPart;
-		ft.dwHighDateTime = ul.HighPart;
-		return output_var->Assign(FileTimeToYYYYMMDD(buf_temp, ft, false));
+		ticks += (__int64)nUnits;  // Seems ok to cast/truncate in light of the *=10000000 above.
+		if (ticks < 0) // Earlier than 1601, which isn't supported (see YYYYMMDDToSystemTime()).
+			return output_var->Assign("");
+		return output_var->Assign(SecondsToYYYYMMDD(buf_temp, ticks / 10000000));
 
 	case ACT_SUB:
 		if (!*ARG3 || !strchr("SMHD", toupper(*ARG3))) // ARG3 is absent or invalid, so do normal math (not date-time).
@@ -13893,6 +14288,10 @@ char *Script::ListKeyHistory(char *aBuf, int aBufSize) // aBufSize should be an
 			timer_list[--length] = '\0';  // Remove the last space if there was room enough for it to have been added.
 	}
 
+	int picture_cache_count;
+	DWORD picture_cache_bytes, picture_cache_hits, picture_cache_misses;
+	GetPictureCacheStats(picture_cache_count, picture_cache_bytes, picture_cache_hits, picture_cache_misses);
+
 	char LRtext[256];
 	aBuf += snprintf(aBuf, aBufSize,
 		"Window: %s"
@@ -13904,6 +14303,8 @@ char *Script::ListKeyHistory(char *aBuf, int aBufSize) // aBufSize should be an
 		"\r\nInterrupted threads: %d%s"
 		"\r\nPaused threads: %d of %d (%d layers)"
 		"\r\nModifiers (GetKeyState() now) = %s"
+		"\r\nClipboard cache: %u hits, %u misses"
+		"\r\nPicture cache: %d images (%u KB), %u hits, %u misses"
 		"\r\n"
 		, win_title
 		//, SimpleHeap::GetBlockCount()
@@ -13915,7 +14316,9 @@ char *Script::ListKeyHistory(char *aBuf, int aBufSize) // aBufSize should be an
 		, g_nThreads > 1 ? " (preempted: they will resume when the current thread finishes)" : ""
 		, g_nPausedThreads - (g_array[0].IsPaused && !mAutoExecSectionIsRunning)  // Historically thread #0 isn't counted as a paused thread unless the auto-exec section is running but paused.
 		, g_nThreads, g_nLayersNeedingTimer
-		, ModifiersLRToText(GetModifierLRState(true), LRtext));
+		, ModifiersLRToText(GetModifierLRState(true), LRtext)
+		, g_clip.mCacheHits, g_clip.mCacheMisses
+		, picture_cache_count, picture_cache_bytes / 1024, picture_cache_hits, picture_cache_misses);
 	GetHookStatus(aBuf, BUF_SPACE_REMAINING);
 	aBuf += strlen(aBuf); // Adjust for what GetHookStatus() wrote to the buffer.
 	return aBuf + snprintf(aBuf, BUF_SPACE_REMAINING, g_KeyHistory ? "\r\nPress [F5] to refresh."
@@ -14227,6 +14630,7 @@ ResultType Script::ActionExec(char *aAction, char *aParams, char *aWorkingDir, b
 	// Otherwise, success:
 	if (aUpdateLastError)
 		g->LastError = 0; // Force zero to indicate success, which seems more maintainable and reliable than calling GetLastError() right here.
+	ProcessTableInvalidate(); // So that a subsequent "Process Exist" is sure to see the new process.
 
 	// If aProcess isn't NULL, the caller wanted the process handle left open and so it must eventually call
 	// CloseHandle().  Otherwise, we should close the process if it's non-NULL (it can be NULL in the case of
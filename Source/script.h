@@ -197,6 +197,7 @@ enum CommandIDs {CONTROL_ID_FIRST = IDCANCEL + 1
 void DoIncrementalMouseMove(int aX1, int aY1, int aX2, int aY2, int aSpeed);
 DWORD ProcessExist9x2000(char *aProcess, char *aProcessName);
 DWORD ProcessExistNT4(char *aProcess, char *aProcessName);
+void ProcessTableInvalidate();
 
 inline DWORD ProcessExist(char *aProcess, char *aProcessName = NULL)
 {
@@ -280,6 +281,7 @@ BOOL CALLBACK EnumChildGetControlList(HWND aWnd, LPARAM lParam);
 BOOL CALLBACK EnumMonitorProc(HMONITOR hMonitor, HDC hdcMonitor, LPRECT lprcMonitor, LPARAM lParam);
 BOOL CALLBACK EnumChildGetText(HWND aWnd, LPARAM lParam);
 LRESULT CALLBACK MainWindowProc(HWND hWnd, UINT iMsg, WPARAM wParam, LPARAM lParam);
+void FormatTimeLocaleChanged();
 bool HandleMenuItem(HWND aHwnd, WORD aMenuItemID, WPARAM aGuiIndex);
 
 
@@ -387,6 +389,17 @@ struct LoopReadFileStruct
 	}
 };
 
+struct FileAppendCacheStruct
+{
+	// An output file that FileAppend keeps open between calls so that scripts which append many
+	// small pieces of text to a log don't pay for an open and close of the file each time.
+	// See Line::FileAppendCacheOpen() for details.
+	FILE *mFile;
+	DWORD mLastUsed; // Tick count used to pick which file to evict.
+	bool mBinary;
+	char mFileName[MAX_PATH];
+};
+
 
 typedef UCHAR ArgCountType;
 #define MAX_ARGS 20   // Maximum number of args used by any command.
@@ -455,7 +468,7 @@ enum MenuCommands {MENU_CMD_INVALID, MENU_CMD_SHOW, MENU_CMD_USEERRORLEVEL
 enum GuiCommands {GUI_CMD_INVALID, GUI_CMD_OPTIONS, GUI_CMD_ADD, GUI_CMD_MARGIN, GUI_CMD_MENU
 	, GUI_CMD_SHOW, GUI_CMD_SUBMIT, GUI_CMD_CANCEL, GUI_CMD_MINIMIZE, GUI_CMD_MAXIMIZE, GUI_CMD_RESTORE
 	, GUI_CMD_DESTROY, GUI_CMD_FONT, GUI_CMD_TAB, GUI_CMD_LISTVIEW, GUI_CMD_TREEVIEW, GUI_CMD_DEFAULT
-	, GUI_CMD_COLOR, GUI_CMD_FLASH
+	, GUI_CMD_COLOR, GUI_CMD_FLASH, GUI_CMD_BEGINUPDATE, GUI_CMD_ENDUPDATE
 };
 
 enum GuiControlCmds {GUICONTROL_CMD_INVALID, GUICONTROL_CMD_OPTIONS, GUICONTROL_CMD_CONTENTS, GUICONTROL_CMD_TEXT
@@ -520,7 +533,8 @@ private:
 	ResultType Line::PerformLoopFilePattern(char **apReturnValue, bool &aContinueMainLoop, Line *&aJumpToLine
 		, FileLoopModeType aFileLoopMode, bool aRecurseSubfolders, char *aFilePattern);
 	ResultType PerformLoopReg(char **apReturnValue, bool &aContinueMainLoop, Line *&aJumpToLine
-		, FileLoopModeType aFileLoopMode, bool aRecurseSubfolders, HKEY aRootKeyType, HKEY aRootKey, char *aRegSubkey);
+		, FileLoopModeType aFileLoopMode, bool aRecurseSubfolders, HKEY aRootKeyType, HKEY aRootKey, char *aRegSubkey
+		, HKEY aRegKey = NULL);
 	ResultType PerformLoopParse(char **apReturnValue, bool &aContinueMainLoop, Line *&aJumpToLine);
 	ResultType Line::PerformLoopParseCSV(char **apReturnValue, bool &aContinueMainLoop, Line *&aJumpToLine);
 	ResultType PerformLoopReadFile(char **apReturnValue, bool &aContinueMainLoop, Line *&aJumpToLine, FILE *aReadFile, char *aWriteFileName);
@@ -808,6 +822,17 @@ public:
 	static DWORD sLogTick[LINE_LOG_SIZE];
 	static int sLogNext;
 
+	// FileAppend keeps up to this many recently used files open, each with a buffer large enough that a
+	// typical FileAppend's text is written to disk in a single write at the end of the call.  The files are
+	// closed whenever the script sleeps or goes idle, and prior to commands, IfExist/FileExist(), file-pattern
+	// loops and DllCall, any of which might operate upon them (see ACT_CLOSES_FILE_APPEND_CACHE):
+	#define FILE_APPEND_CACHE_SIZE 8
+	#define FILE_APPEND_BUF_SIZE (64 * 1024)
+	static FileAppendCacheStruct sFileAppendCache[FILE_APPEND_CACHE_SIZE];
+	static int sFileAppendCacheCount;
+	static FileAppendCacheStruct *FileAppendCacheOpen(char *aFilespec, bool aBinary);
+	static void FileAppendCacheClose(char *aFilespec = NULL);
+
 #ifdef AUTOHOTKEYSC  // Reduces code size to omit things that are unused, and helps catch bugs at compile-time.
 	static char *sSourceFile[1]; // Only need to be able to hold the main script since compiled scripts don't support dynamic including.
 #else
@@ -882,7 +907,7 @@ public:
 
 	Var *ResolveVarOfArg(int aArgIndex, bool aCreateIfNecessary = true);
 	ResultType ExpandArgs(VarSizeType aSpaceNeeded = VARSIZE_ERROR, Var *aArgVar[] = NULL);
-	VarSizeType GetExpandedArgSize(Var *aArgVar[]);
+	VarSizeType GetExpandedArgSize(Var *aArgVar[], ResultType aArgMustDeref[]);
 	char *ExpandArg(char *aBuf, int aArgIndex, Var *aArgVar = NULL);
 	char *ExpandExpression(int aArgIndex, ResultType &aResult, char *&aTarget, char *&aDerefBuf
 		, size_t &aDerefBufSize, char *aArgDeref[], size_t aExtraSize);
@@ -1358,6 +1383,8 @@ public:
 		if (!stricmp(aBuf, "Default")) return GUI_CMD_DEFAULT;
 		if (!stricmp(aBuf, "Color")) return GUI_CMD_COLOR;
 		if (!stricmp(aBuf, "Flash")) return GUI_CMD_FLASH;
+		if (!stricmp(aBuf, "BeginUpdate")) return GUI_CMD_BEGINUPDATE;
+		if (!stricmp(aBuf, "EndUpdate")) return GUI_CMD_ENDUPDATE;
 		return GUI_CMD_INVALID;
 	}
 
@@ -1939,17 +1966,20 @@ class ScriptTimer
 public:
 	Label *mLabel;
 	DWORD mPeriod; // v1.0.36.33: Changed from int to DWORD to double its capacity.
-	DWORD mTimeLastRun;  // TickCount
+	unsigned __int64 mTimeLastRun;  // 64-bit TickCount from GetTickCount64Ex(), so that the due-time below never wraps.
 	int mPriority;  // Thread priority relative to other threads, default 0.
+	UINT mOrdinal;  // Position of this timer in the linked list, used to launch simultaneously-due timers in list order.
+	int mHeapIndex; // Position in g_script.mTimerHeap, or -1 if the timer is disabled (and thus not in the heap).
 	UCHAR mExistingThreads;  // Whether this timer is already running its subroutine.
 	bool mEnabled;
 	bool mRunOnlyOnce;
 	ScriptTimer *mNextTimer;  // Next items in linked list
 	void ScriptTimer::Disable();
-	ScriptTimer(Label *aLabel)
+	unsigned __int64 DueTime() {return mTimeLastRun + mPeriod;}
+	ScriptTimer(Label *aLabel, UINT aOrdinal)
 		#define DEFAULT_TIMER_PERIOD 250
 		: mLabel(aLabel), mPeriod(DEFAULT_TIMER_PERIOD), mPriority(0) // Default is always 0.
-		, mExistingThreads(0), mTimeLastRun(0)
+		, mOrdinal(aOrdinal), mHeapIndex(-1), mExistingThreads(0), mTimeLastRun(0)
 		, mEnabled(false), mRunOnlyOnce(false), mNextTimer(NULL)  // Note that mEnabled must default to false for the counts to be right.
 	{}
 	void *operator new(size_t aBytes) {return SimpleHeap::Malloc(aBytes);}
@@ -2079,6 +2109,36 @@ struct lv_col_type
 	bool prefer_descending; // Whether this column defaults to descending order (on first click or for unidirectional).
 };
 
+struct tv_pending_type // The not-yet-added descendants of a TreeView item added by TV_AddMany() in lazy mode.
+{
+	int base_depth; // The number of leading tabs that denotes a direct child of the item.
+	char text[1];   // The descendants' lines (see TV_AddLines()), allocated with enough room for all of them.
+};
+int TV_AddLines(HWND aTreeHwnd, HTREEITEM aParent, char *aText, int aBaseDepth, bool aLazy);
+tv_pending_type *TV_TakePending(HWND aTreeHwnd, HTREEITEM aItem, LPARAM aParam);
+void TV_FreeAllPending(HWND aTreeHwnd);
+
+struct lv_virtual_type
+// For ListViews that have the "Virtual" option (LVS_OWNERDATA), the rows are stored here rather than inside
+// the control, which merely asks for the text of each visible field via LVN_GETDISPINFO.  This uses far less
+// memory and time per row than the control's own storage.  The layout is columnar: all text lives in a single
+// arena, and each column has its own array of offsets into it.  Rows aren't moved once stored; instead,
+// "order" maps each displayed row to its stored (data) row, so sorting, inserting and deleting only
+// rearrange that array.  Text that is replaced or deleted is left in the arena until it adds up to a
+// large enough fraction of it, at which time LV_VirtualCompact() rebuilds the arena and column arrays.
+{
+	char *text;           // Arena containing the text of every field, each zero-terminated.  text[0] is always an empty string.
+	size_t text_length;   // Number of bytes of the arena in use.
+	size_t text_capacity;
+	size_t text_orphaned; // Number of bytes of the arena occupied by text that is no longer referenced.
+	UINT *field[LV_MAX_COLUMNS];    // For each column, the offset into "text" of each data row's field; NULL until the column is first given text.
+	double *number[LV_MAX_COLUMNS]; // For each column, the cached numeric value of each data row's field (for sorting); NULL until needed or after being invalidated.
+	int *order;           // Maps each displayed row to its data row.
+	int row_count;        // Number of displayed rows (elements of "order" in use).
+	int data_count;       // Number of data rows in use, including those orphaned by deletion.
+	int data_capacity;    // Capacity of "order" and of each column's arrays.
+};
+
 struct lv_attrib_type
 {
 	int sorted_by_col; // Index of column by which the control is currently sorted (-1 if none).
@@ -2088,6 +2148,7 @@ struct lv_attrib_type
 	lv_col_type col[LV_MAX_COLUMNS];
 	int col_count; // Number of columns currently in the above array.
 	int row_count_hint;
+	lv_virtual_type *virt; // NULL unless this is a virtual ListView (see lv_virtual_type).
 };
 
 typedef UCHAR TabControlIndexType;
@@ -2112,6 +2173,9 @@ struct GuiControlType
 	UCHAR attrib; // A field of option flags/bits defined above.
 	TabControlIndexType tab_control_index; // Which tab control this control belongs to, if any.
 	TabIndexType tab_index; // For type==TAB, this stores the tab control's index.  For other types, it stores the page.
+	#define GUI_REDRAW_OFF_BY_SCRIPT 0x01 // The script turned off redrawing via "GuiControl -Redraw".
+	#define GUI_REDRAW_OFF_BY_UPDATE 0x02 // "Gui BeginUpdate" turned off redrawing (see GuiType::BeginUpdate()).
+	UCHAR redraw_off; // Zero if redrawing is on; otherwise a combination of the flags above (occupies what would otherwise be padding).
 	Var *output_var;
 	Label *jump_to_label;
 	union
@@ -2126,6 +2190,14 @@ struct GuiControlType
 		|| type == GUI_CONTROL_SLIDER || type == GUI_CONTROL_PROGRESS)
 };
 
+struct GuiVarIndexType
+{
+	// An element of GuiType::mControlByVar, which is kept sorted by var (i.e. by address) so that
+	// a control can be found from its associated variable via binary search.
+	Var *var;
+	GuiIndexType control_index;
+};
+
 struct GuiControlOptionsType
 {
 	DWORD style_add, style_remove, exstyle_add, exstyle_remove, listview_style;
@@ -2183,6 +2255,8 @@ public:
 	GuiIndexType mControlCount;
 	GuiIndexType mControlCapacity; // How many controls can fit into the current memory size of mControl.
 	GuiControlType *mControl; // Will become an array of controls when the window is first created.
+	GuiVarIndexType *mControlByVar; // Has the same capacity as mControl so that adding to it can't fail.
+	GuiIndexType mControlByVarCount;
 	GuiIndexType mDefaultButtonIndex; // Index vs. pointer is needed for some things.
 	Label *mLabelForClose, *mLabelForEscape, *mLabelForSize, *mLabelForDropFiles, *mLabelForContextMenu;
 	bool mLabelForCloseIsRunning, mLabelForEscapeIsRunning, mLabelForSizeIsRunning; // DropFiles doesn't need one of these.
@@ -2209,12 +2283,16 @@ public:
 	LONG mMinWidth, mMinHeight, mMaxWidth, mMaxHeight;
 	bool mGuiShowHasNeverBeenDone, mFirstActivation, mShowIsInProgress, mDestroyWindowHasBeenCalled;
 	bool mControlWidthWasSetByContents; // Whether the most recently added control was auto-width'd to fit its contents.
+	int mUpdateDepth;    // How many "Gui BeginUpdate" are in effect without a matching EndUpdate.
+	int mUpdatesSkipped; // How many GuiControl text changes were skipped during the current update because the text was unchanged.
+	global_struct *mUpdateThread; // The thread that began the current update, which ends it if the script doesn't.
 
 	#define MAX_GUI_FONTS 200  // v1.0.44.14: Increased from 100 to 200 due to feedback that 100 wasn't enough.  But to alleviate memory usage, the array is now allocated upon first use.
 	static FontType *sFont; // An array of structs, allocated upon first use.
 	static int sFontCount;
 	static int sGuiCount; // The number of non-NULL items in the g_gui array. Maintained only for performance reasons.
-	static HWND sTreeWithEditInProgress; // Needed because TreeView's edit control for label-editing conflicts with IDOK (default button).
+	static HWND sTreeWithEditInProgress;
+	static int sUpdateCount; // The number of windows that have an update in progress, so that EndThreadUpdates() is usually free. // Needed because TreeView's edit control for label-editing conflicts with IDOK (default button).
 
 	// Don't overload new and delete operators in this case since we want to use real dynamic memory
 	// (since GUIs can be destroyed and recreated, over and over).
@@ -2224,6 +2302,7 @@ public:
 
 	GuiType(int aWindowIndex) // Constructor
 		: mHwnd(NULL), mStatusBarHwnd(NULL), mWindowIndex(aWindowIndex), mControlCount(0), mControlCapacity(0)
+		, mControlByVar(NULL), mControlByVarCount(0)
 		, mDefaultButtonIndex(-1), mLabelForClose(NULL), mLabelForEscape(NULL), mLabelForSize(NULL)
 		, mLabelForDropFiles(NULL), mLabelForContextMenu(NULL)
 		, mLabelForCloseIsRunning(false), mLabelForEscapeIsRunning(false), mLabelForSizeIsRunning(false)
@@ -2254,6 +2333,7 @@ public:
 		, mMaxWidth(COORD_UNSPECIFIED), mMaxHeight(COORD_UNSPECIFIED)
 		, mGuiShowHasNeverBeenDone(true), mFirstActivation(true), mShowIsInProgress(false)
 		, mDestroyWindowHasBeenCalled(false), mControlWidthWasSetByContents(false)
+		, mUpdateDepth(0), mUpdatesSkipped(0), mUpdateThread(NULL)
 	{
 		// The array of controls is left unitialized to catch bugs.  Each control's attributes should be
 		// fully populated when it is created.
@@ -2278,6 +2358,15 @@ public:
 	ResultType Show(char *aOptions, char *aTitle);
 	ResultType Clear();
 	ResultType Cancel();
+	void BeginUpdate();
+	int EndUpdate(bool aEndAll);
+	static void EndThreadUpdates();
+	void ControlThaw(GuiControlType &aControl);
+	// While an update has frozen a control, WM_SETREDRAW has cleared its WS_VISIBLE, so IsWindowVisible()
+	// would wrongly report it as hidden.  Since only visible controls are frozen, check the window instead:
+	bool ControlIsVisible(GuiControlType &aControl) {return IsWindowVisible((aControl.redraw_off & GUI_REDRAW_OFF_BY_UPDATE)
+		? mHwnd : aControl.hwnd) != FALSE;}
+	bool ControlTextIsUnchanged(HWND aControlHwnd, char *aNewText);
 	ResultType Close(); // Due to SC_CLOSE, etc.
 	ResultType Escape(); // Similar to close, except typically called when the user presses ESCAPE.
 	ResultType Submit(bool aHideIt);
@@ -2309,6 +2398,8 @@ public:
 
 
 	GuiIndexType FindControl(char *aControlID);
+	GuiIndexType FindControlByVar(Var *aVar);
+	void IndexControlVar(GuiIndexType aControlIndex, Var *aOldVar);
 	GuiControlType *FindControl(HWND aHwnd, bool aRetrieveIndexInstead = false)
 	{
 		GuiIndexType index = GUI_HWND_TO_INDEX(aHwnd); // Retrieves a small negative on failure, which will be out of bounds when converted to unsigned.
@@ -2355,11 +2446,40 @@ public:
 		, bool aWrapAround);
 	void ControlGetPosOfFocusedItem(GuiControlType &aControl, POINT &aPoint);
 	static void LV_Sort(GuiControlType &aControl, int aColumnIndex, bool aSortOnlyIfEnabled, char aForceDirection = '\0');
+	static void LV_VirtualSort(GuiControlType &aControl, int aColumnIndex, lv_col_type &aCol, bool aSortAscending);
+	static bool LV_VirtualReserve(lv_virtual_type &aVirt, int aRowCount, size_t aTextLength);
+	static int LV_VirtualInsertRow(lv_virtual_type &aVirt, int aRowIndex);
+	static bool LV_VirtualSetText(lv_virtual_type &aVirt, int aRowIndex, int aColumnIndex, char *aText);
+	static char *LV_VirtualGetText(lv_virtual_type &aVirt, int aRowIndex, int aColumnIndex);
+	static void LV_VirtualDeleteRow(lv_virtual_type &aVirt, int aRowIndex);
+	static void LV_VirtualDeleteAll(lv_virtual_type &aVirt);
+	static void LV_VirtualInsertDeleteCol(lv_virtual_type &aVirt, int aColumnIndex, bool aInsert);
+	static bool LV_VirtualCompact(lv_virtual_type &aVirt);
 	static DWORD ControlGetListViewMode(HWND aWnd);
 };
 
 
 
+#ifndef AUTOHOTKEYSC
+class ScriptFile
+// A read-only memory-mapped view of an entire script file, which Script::GetLine() splits into lines.
+// This avoids the per-line overhead of fgets() (locking, text-mode translation, and copying through
+// the CRT's small buffer), which is significant for very large scripts.
+{
+public:
+	char *mPos, *mEnd; // The position of the next line and the end of the file's contents.
+	ResultType Open(char *aFileSpec);
+	void Close();
+	ScriptFile() : mPos(NULL), mEnd(NULL), mFile(INVALID_HANDLE_VALUE), mMapping(NULL), mView(NULL) {}
+	~ScriptFile() {Close();}
+private:
+	HANDLE mFile, mMapping;
+	char *mView;
+};
+#endif
+
+
+
 class Script
 {
 private:
@@ -2367,7 +2487,11 @@ private:
 	Line *mFirstLine, *mLastLine;     // The first and last lines in the linked list.
 	UINT mLineCount;                  // The number of lines.
 	Label *mFirstLabel, *mLastLabel;  // The first and last labels in the linked list.
+	Label **mLabel; // Array of all labels sorted by name (duplicates in the order they were added), for use by FindLabel().
+	int mLabelCount, mLabelCountMax; // Count of items in the above array as well as the maximum capacity.
 	Func *mFirstFunc, *mLastFunc;     // The first and last functions in the linked list.
+	Func **mFunc; // Array of all functions sorted by name, which allows FindFunc() to use a binary search.
+	int mFuncCount, mFuncCountMax; // Count of items in the above array as well as the maximum capacity.
 	Var **mVar, **mLazyVar; // Array of pointers-to-variable, allocated upon first use and later expanded as needed.
 	int mVarCount, mVarCountMax, mLazyVarCount; // Count of items in the above array as well as the maximum capacity.
 	WinGroup *mFirstGroup, *mLastGroup;  // The first and last variables in the linked list.
@@ -2396,8 +2520,8 @@ private:
 	size_t GetLine(char *aBuf, int aMaxCharsToRead, int aInContinuationSection, UCHAR *&aMemFile);
 #else
 	#define CloseAndReturnFail(fp, aBuf) CloseAndReturnFailFunc(fp)
-	ResultType CloseAndReturnFailFunc(FILE *fp);
-	size_t GetLine(char *aBuf, int aMaxCharsToRead, int aInContinuationSection, FILE *fp);
+	ResultType CloseAndReturnFailFunc(ScriptFile *fp);
+	size_t GetLine(char *aBuf, int aMaxCharsToRead, int aInContinuationSection, ScriptFile *fp);
 #endif
 	ResultType IsDirective(char *aBuf);
 
@@ -2433,6 +2557,14 @@ public:
 
 	ScriptTimer *mFirstTimer, *mLastTimer;  // The first and last script timers in the linked list.
 	UINT mTimerCount, mTimerEnabledCount;
+	// Binary min-heap of all enabled timers, ordered by ScriptTimer::DueTime().  It always contains exactly
+	// mTimerEnabledCount items and has room for mTimerCount, so inserting into it can never fail:
+	ScriptTimer **mTimerHeap;
+	UINT mTimerHeapCapacity;
+	void TimerHeapInsert(ScriptTimer *aTimer);
+	void TimerHeapRemove(ScriptTimer *aTimer);
+	void TimerHeapUpdate(ScriptTimer *aTimer);
+	int GetDueTimers(ScriptTimer *aDueTimer[], int aMaxTimers, unsigned __int64 aTickNow, int aMinPriority);
 
 	UserMenu *mFirstMenu, *mLastMenu;
 	UINT mMenuCount;
@@ -2678,6 +2810,7 @@ void BIF_IsLabel(ExprTokenType &aResultToken, ExprTokenType *aParam[], int aPara
 void BIF_IsFunc(ExprTokenType &aResultToken, ExprTokenType *aParam[], int aParamCount);
 void BIF_GetKeyState(ExprTokenType &aResultToken, ExprTokenType *aParam[], int aParamCount);
 void BIF_VarSetCapacity(ExprTokenType &aResultToken, ExprTokenType *aParam[], int aParamCount);
+void BIF_RandomFill(ExprTokenType &aResultToken, ExprTokenType *aParam[], int aParamCount);
 void BIF_FileExist(ExprTokenType &aResultToken, ExprTokenType *aParam[], int aParamCount);
 void BIF_WinExistActive(ExprTokenType &aResultToken, ExprTokenType *aParam[], int aParamCount);
 void BIF_Round(ExprTokenType &aResultToken, ExprTokenType *aParam[], int aParamCount);
@@ -2700,11 +2833,13 @@ void BIF_StatusBar(ExprTokenType &aResultToken, ExprTokenType *aParam[], int aPa
 void BIF_LV_GetNextOrCount(ExprTokenType &aResultToken, ExprTokenType *aParam[], int aParamCount);
 void BIF_LV_GetText(ExprTokenType &aResultToken, ExprTokenType *aParam[], int aParamCount);
 void BIF_LV_AddInsertModify(ExprTokenType &aResultToken, ExprTokenType *aParam[], int aParamCount);
+void BIF_LV_AddMany(ExprTokenType &aResultToken, ExprTokenType *aParam[], int aParamCount);
 void BIF_LV_Delete(ExprTokenType &aResultToken, ExprTokenType *aParam[], int aParamCount);
 void BIF_LV_InsertModifyDeleteCol(ExprTokenType &aResultToken, ExprTokenType *aParam[], int aParamCount);
 void BIF_LV_SetImageList(ExprTokenType &aResultToken, ExprTokenType *aParam[], int aParamCount);
 
 void BIF_TV_AddModifyDelete(ExprTokenType &aResultToken, ExprTokenType *aParam[], int aParamCount);
+void BIF_TV_AddMany(ExprTokenType &aResultToken, ExprTokenType *aParam[], int aParamCount);
 void BIF_TV_GetRelatedItem(ExprTokenType &aResultToken, ExprTokenType *aParam[], int aParamCount);
 void BIF_TV_Get(ExprTokenType &aResultToken, ExprTokenType *aParam[], int aParamCount);
 
@@ -2869,6 +2869,7 @@ ResultType Line::ScriptProcess(char *aCmd, char *aProcess, char *aParam3)
 			{
 				result = TerminateProcess(hProcess, 0);
 				CloseHandle(hProcess);
+				ProcessTableInvalidate(); // So that the terminated process isn't reported by a subsequent "Process Exist".
 				return g_ErrorLevel->Assign(result ? pid : 0); // Indicate success or failure.
 			}
 		}
@@ -4833,7 +4834,7 @@ LRESULT CALLBACK MainWindowProc(HWND hWnd, UINT iMsg, WPARAM wParam, LPARAM lPar
 
 	// See GuiWindowProc() for details about this first section:
 	LRESULT msg_reply;
-	if (g_MsgMonitorCount // Count is checked here to avoid function-call overhead.
+	if (MSG_MAY_BE_MONITORED(iMsg) // Filter is checked here to avoid function-call overhead.
 		&& (!g->CalledByIsDialogMessageOrDispatch || g->CalledByIsDialogMessageOrDispatchMsg != iMsg) // v1.0.44.11: If called by IsDialog or Dispatch but they changed the message number, check if the script is monitoring that new number.
 		&& MsgMonitor(hWnd, iMsg, wParam, lParam, NULL, msg_reply))
 		return msg_reply; // MsgMonitor has returned "true", indicating that this message should be omitted from further processing.
@@ -5058,6 +5059,11 @@ LRESULT CALLBACK MainWindowProc(HWND hWnd, UINT iMsg, WPARAM wParam, LPARAM lPar
 		// (perhaps the splash window).  Let DefWindowProc() handle it:
 		break;
 
+	case WM_SETTINGCHANGE:
+		// The user might have changed their calendar or other regional settings, which FormatTime caches:
+		FormatTimeLocaleChanged();
+		break; // Let DefWindowProc() handle it too.
+
 	case WM_ENDSESSION: // MSDN: "A window receives this message through its WindowProc function."
 		if (wParam) // The session is being ended.
 			g_script.ExitApp((lParam & ENDSESSION_LOGOFF) ? EXIT_LOGOFF : EXIT_SHUTDOWN);
@@ -5229,6 +5235,7 @@ LRESULT CALLBACK MainWindowProc(HWND hWnd, UINT iMsg, WPARAM wParam, LPARAM lPar
 		break;
 
 	case WM_DRAWCLIPBOARD:
+		g_clip.InvalidateCache(); // The sequence number would also reveal the change, but this is more certain.
 		if (g_script.mOnClipboardChangeLabel) // In case it's a bogus msg, it's our responsibility to avoid posting the msg if there's no label to launch.
 			PostMessage(g_hWnd, AHK_CLIPBOARD_CHANGE, 0, 0); // It's done this way to buffer it when the script is uninterruptible, etc.  v1.0.44: Post to g_hWnd vs. NULL so that notifications aren't lost when script is displaying a MsgBox or other dialog.
 		if (g_script.mNextClipboardViewer) // Will be NULL if there are no other windows in the chain.
@@ -5664,7 +5671,7 @@ BOOL CALLBACK InputBoxProc(HWND hWndDlg, UINT uMsg, WPARAM wParam, LPARAM lParam
 {
 	// See GuiWindowProc() for details about this first part:
 	LRESULT msg_reply;
-	if (g_MsgMonitorCount // Count is checked here to avoid function-call overhead.
+	if (MSG_MAY_BE_MONITORED(uMsg) // Filter is checked here to avoid function-call overhead.
 		&& (!g->CalledByIsDialogMessageOrDispatch || g->CalledByIsDialogMessageOrDispatchMsg != uMsg) // v1.0.44.11: If called by IsDialog or Dispatch but they changed the message number, check if the script is monitoring that new number.
 		&& MsgMonitor(hWndDlg, uMsg, wParam, lParam, NULL, msg_reply))
 		return (BOOL)msg_reply; // MsgMonitor has returned "true", indicating that this message should be omitted from further processing.
@@ -6139,6 +6146,202 @@ BOOL CALLBACK EnumChildFindPoint(HWND aWnd, LPARAM lParam)
 // Related to other commands //
 ///////////////////////////////
 
+// FormatTime caches a "compiled" form of the most recently used format strings.  A format that consists
+// only of numeric fields (such as "yyyy-MM-dd HH:mm:ss") is rendered directly from the SYSTEMTIME, which
+// is much faster than translating the format and calling GetDateFormat()/GetTimeFormat() for every call
+// (scripts that write a log often call FormatTime once per line).  Formats with anything whose output
+// depends on the locale (month/day names, AM/PM, era) or that are otherwise unusual are left to the
+// API so that the output stays exactly the same.
+#define FT_FORMAT_NONE 0
+#define FT_FORMAT_TIME 1
+#define FT_FORMAT_DATE 2
+
+struct FormatTimeProgram
+{
+	#define FT_PROGRAM_MAX_FORMAT 64
+	char format[FT_PROGRAM_MAX_FORMAT + 1]; // The format string this program was compiled from.
+	UINT last_used; // The value of sFormatTimeCacheUses when this program was last used, for LRU eviction.
+	bool is_numeric; // If false, the format must be handled by the API and the tokens below are unused.
+	int token_count;
+	struct
+	{
+		char field; // One of "yMdHhms", or '\0' to indicate that "width" is a literal character.
+		char width; // The number of repetitions of "field", e.g. 2 for "MM".
+	} token[FT_PROGRAM_MAX_FORMAT];
+};
+#define FT_PROGRAM_CACHE_SIZE 8
+static FormatTimeProgram sFormatTimeCache[FT_PROGRAM_CACHE_SIZE];
+static int sFormatTimeCacheCount = 0;
+static UINT sFormatTimeCacheUses = 0; // Incremented each time a program is used (wrapping around is harmless).
+
+
+
+static FormatTimeProgram *FormatTimeGetProgram(char *aFormat)
+// Returns the compiled program for aFormat, compiling it first if it isn't cached.
+// Returns NULL if aFormat is too long to be cached.
+{
+	int i, slot;
+	++sFormatTimeCacheUses;
+	for (i = 0; i < sFormatTimeCacheCount; ++i)
+		if (!strcmp(sFormatTimeCache[i].format, aFormat)) // Case sensitive because "M" and "m" differ.
+		{
+			sFormatTimeCache[i].last_used = sFormatTimeCacheUses;
+			return sFormatTimeCache + i;
+		}
+	if (strlen(aFormat) > FT_PROGRAM_MAX_FORMAT)
+		return NULL;
+
+	// Use a new entry if the cache isn't full yet; otherwise, replace the least recently used one:
+	if (sFormatTimeCacheCount < FT_PROGRAM_CACHE_SIZE)
+		slot = sFormatTimeCacheCount++;
+	else
+		for (slot = 0, i = 1; i < FT_PROGRAM_CACHE_SIZE; ++i)
+			if (sFormatTimeCacheUses - sFormatTimeCache[i].last_used > sFormatTimeCacheUses - sFormatTimeCache[slot].last_used)
+				slot = i;
+	FormatTimeProgram &prog = sFormatTimeCache[slot];
+	prog.last_used = sFormatTimeCacheUses;
+	strcpy(prog.format, aFormat);
+	prog.is_numeric = false; // Set default in case of early return below.
+	prog.token_count = 0;
+
+	// FormatTime splits the format in two at the first field whose type (date or time) differs from that
+	// of the first field, then hands each part to GetDateFormat() or GetTimeFormat() according to type.
+	// Only formats in which every field is rendered by the API of its own type are compiled, since the
+	// APIs treat fields of the other type in ways that aren't worth replicating.
+	int section_type = FT_FORMAT_NONE, field_type, width;
+	bool was_split = false;
+	char *cp, c;
+	for (cp = aFormat; c = *cp; cp += width)
+	{
+		if ((UCHAR)c > 127 || c == '\'') // Non-ASCII letters might be alphanumeric in the user's locale; quotes have special meaning.
+			return &prog;
+		for (width = 1; cp[width] == c; ++width); // Count repetitions, e.g. "yyyy" is 4.
+		switch (c)
+		{
+		case 'y':
+			if (width == 3 || width > 4)
+				return &prog;
+			field_type = FT_FORMAT_DATE;
+			break;
+		case 'M': // Fall through to the next.
+		case 'd':
+			if (width > 2) // A month or day name (or something unusual).
+				return &prog;
+			field_type = FT_FORMAT_DATE;
+			break;
+		case 'H':
+		case 'h':
+		case 'm':
+		case 's':
+			if (width > 2)
+				return &prog;
+			field_type = FT_FORMAT_TIME;
+			break;
+		default:
+			if (IsCharAlphaNumeric(c)) // Any other letter (e.g. "tt" or "g") or a digit.
+				return &prog;
+			// Otherwise, it's punctuation or whitespace, which FormatTime always passes through as-is.
+			width = 1; // Each literal char is its own token.
+			prog.token[prog.token_count].field = '\0';
+			prog.token[prog.token_count++].width = c;
+			continue;
+		}
+		if (section_type != field_type)
+		{
+			if (section_type == FT_FORMAT_NONE)
+				section_type = field_type;
+			else if (!was_split)
+			{
+				section_type = field_type;
+				was_split = true;
+			}
+			else // A field of the first part's type appears after the split.
+				return &prog;
+		}
+		prog.token[prog.token_count].field = c;
+		prog.token[prog.token_count++].width = (char)width;
+	}
+	prog.is_numeric = true;
+	return &prog;
+}
+
+
+
+static LCID sFormatTimeLcid;
+static bool sFormatTimeLcidIsKnown = false, sFormatTimeLcidIsGregorian;
+
+void FormatTimeLocaleChanged()
+// Called upon WM_SETTINGCHANGE so that a change to the user's calendar takes effect immediately.
+{
+	sFormatTimeLcidIsKnown = false;
+}
+
+static bool FormatTimeLocaleIsGregorian(LCID aLcid)
+// Returns true if aLcid uses the Gregorian calendar, which is the only one FormatTimeRun() can render.
+// Other calendars (e.g. Thai Buddhist or Japanese era) make GetDateFormat() show different year, month
+// or day numbers.  The result is cached for the most recent locale since looking it up costs nearly as
+// much as the formatting it's meant to avoid (see FormatTimeLocaleChanged()).
+{
+	if (!sFormatTimeLcidIsKnown || aLcid != sFormatTimeLcid)
+	{
+		char buf[8];
+		sFormatTimeLcidIsGregorian = GetLocaleInfo(aLcid, LOCALE_ICALENDARTYPE, buf, sizeof(buf)) && ATOI(buf) == CAL_GREGORIAN;
+		sFormatTimeLcid = aLcid;
+		sFormatTimeLcidIsKnown = true;
+	}
+	return sFormatTimeLcidIsGregorian;
+}
+
+
+
+static bool FormatTimeRun(FormatTimeProgram &aProg, SYSTEMTIME &aTime, char *aBuf)
+// Renders aTime into aBuf according to aProg, which must be numeric.  aBuf must be large enough
+// (4 chars per token is enough).  Returns false if aTime is invalid, in which case the caller should
+// let the API handle it so that the outcome for invalid times stays the same.
+{
+	static const char days_in_month[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+	if (aTime.wYear < 1601 || aTime.wYear > 9999 || aTime.wMonth < 1 || aTime.wMonth > 12 || aTime.wDay < 1
+		|| aTime.wDay > days_in_month[aTime.wMonth - 1] + (aTime.wMonth == 2 && IS_LEAP_YEAR(aTime.wYear))
+		|| aTime.wHour > 23 || aTime.wMinute > 59 || aTime.wSecond > 59)
+		return false;
+	int value;
+	for (int i = 0; i < aProg.token_count; ++i)
+	{
+		switch (aProg.token[i].field)
+		{
+		case '\0':
+			*aBuf++ = aProg.token[i].width; // A literal char.
+			continue;
+		case 'y':
+			if (aProg.token[i].width == 4)
+			{
+				value = aTime.wYear; // Caller has ensured it's four digits.
+				*aBuf++ = '0' + value / 1000;
+				*aBuf++ = '0' + value / 100 % 10;
+				*aBuf++ = '0' + value / 10 % 10;
+				*aBuf++ = '0' + value % 10;
+				continue;
+			}
+			value = aTime.wYear % 100;
+			break;
+		case 'M': value = aTime.wMonth; break;
+		case 'd': value = aTime.wDay; break;
+		case 'H': value = aTime.wHour; break;
+		case 'h': value = aTime.wHour % 12 ? aTime.wHour % 12 : 12; break;
+		case 'm': value = aTime.wMinute; break;
+		default:  value = aTime.wSecond; break; // 's'
+		}
+		// All remaining fields are less than 100.  A width of 1 omits the leading zero.
+		if (value > 9 || aProg.token[i].width == 2)
+			*aBuf++ = '0' + value / 10;
+		*aBuf++ = '0' + value % 10;
+	}
+	*aBuf = '\0';
+	return true;
+}
+
+
+
 ResultType Line::FormatTime(char *aYYYYMMDD, char *aFormat)
 // The compressed code size of this function is about 1 KB (2 KB uncompressed), which compares
 // favorably to using setlocale()+strftime(), which together are about 8 KB of compressed code
@@ -6198,9 +6401,6 @@ ResultType Line::FormatTime(char *aYYYYMMDD, char *aFormat)
 	LCID lcid = LOCALE_USER_DEFAULT;
 	DWORD date_flags = 0, time_flags = 0;
 	bool date_flags_specified = false, time_flags_specified = false, reverse_date_time = false;
-	#define FT_FORMAT_NONE 0
-	#define FT_FORMAT_TIME 1
-	#define FT_FORMAT_DATE 2
 	int format_type1 = FT_FORMAT_NONE;
 	char *format2_marker = NULL; // Will hold the location of the first char of the second format (if present).
 	bool do_null_format2 = false;  // Will be changed to true if a default date *and* time should be used.
@@ -6305,6 +6505,14 @@ ResultType Line::FormatTime(char *aYYYYMMDD, char *aFormat)
 		}
 		else // Assume normal format string.
 		{
+			// If there are no options (which could affect the output in ways not replicated by
+			// FormatTimeRun) and the locale uses the Gregorian calendar, try the fast method first:
+			if ((!options || !*options) && FormatTimeLocaleIsGregorian(lcid))
+			{
+				FormatTimeProgram *prog = FormatTimeGetProgram(aFormat);
+				if (prog && prog->is_numeric && FormatTimeRun(*prog, st, output_buf))
+					return output_var.Assign(output_buf);
+			}
 			char *cp = aFormat, *dp = format_buf;   // Initialize source and destination pointers.
 			bool inside_their_quotes = false; // Whether we are inside a single-quoted string in the source.
 			bool inside_our_quotes = false;   // Whether we are inside a single-quoted string of our own making in dest.
@@ -8650,6 +8858,7 @@ ResultType Line::FileRead(char *aFilespec)
 	bool translate_crlf_to_lf = false;
 	bool is_binary_clipboard = false;
 	unsigned __int64 max_bytes_to_load = ULLONG_MAX;
+	unsigned __int64 offset = 0;
 
 	// It's done as asterisk+option letter to permit future expansion.  A plain asterisk such as used
 	// by the FileAppend command would create ambiguity if there was ever an effort to add other asterisk-
@@ -8674,6 +8883,12 @@ ResultType Line::FileRead(char *aFilespec)
 				return OK; // Let ErrorLevel tell the story.
 			--cp; // Standardize it to make it conform to the other options, for use below.
 			break;
+		case 'O': // Offset at which to start reading, which allows a slice of a file too large to load in its entirety (e.g. *o1000000000 *m1000000).
+			offset = ATOU64(cp + 1);
+			if (   !(cp = StrChrAny(cp, " \t"))   ) // See 'M' above.
+				return OK; // Let ErrorLevel tell the story.
+			--cp;
+			break;
 		case 'T': // Text mode.
 			translate_crlf_to_lf = true;
 			break;
@@ -8717,7 +8932,20 @@ ResultType Line::FileRead(char *aFilespec)
 	// clipboard file should already have the (UINT)0 as its ending terminator.
 
 	unsigned __int64 bytes_to_read = GetFileSize64(hfile);
-	if (bytes_to_read == ULLONG_MAX // GetFileSize64() failed...
+	if (bytes_to_read != ULLONG_MAX) // GetFileSize64() succeeded.
+	{
+		if (offset)
+		{
+			LONG offset_high = (LONG)(offset >> 32);
+			if (offset >= bytes_to_read // Nothing to read (or reading would start beyond the end).
+				|| SetFilePointer(hfile, (LONG)(offset & 0xFFFFFFFF), &offset_high, FILE_BEGIN) == INVALID_SET_FILE_POINTER
+					&& GetLastError() != NO_ERROR) // MSDN: INVALID_SET_FILE_POINTER can also be a valid low-order DWORD of a large offset.
+				bytes_to_read = (offset == bytes_to_read) ? 0 : ULLONG_MAX; // Reading from exactly the end yields an empty result; beyond it is an error.
+			else
+				bytes_to_read -= offset; // The size of the remainder of the file is what matters below.
+		}
+	}
+	if (bytes_to_read == ULLONG_MAX // GetFileSize64() or SetFilePointer() failed...
 		|| max_bytes_to_load == ULLONG_MAX && bytes_to_read > FILEREAD_MAX) // ...or the file is too large to be completely read (and the script wanted it completely read).
 	{
 		CloseHandle(hfile);
@@ -8743,8 +8971,71 @@ ResultType Line::FileRead(char *aFilespec)
 	}
 	char *output_buf = output_var.Contents();
 
-	DWORD bytes_actually_read;
-	BOOL result = ReadFile(hfile, output_buf, (DWORD)bytes_to_read, &bytes_actually_read, NULL);
+	// The file is read directly into the variable in chunks rather than all at once.  This allows any
+	// CRLF-to-LF translation to be done on each chunk while it's still in the CPU cache, rather than
+	// in a separate pass over the entire (possibly huge) contents afterward.  Since translation only
+	// ever shrinks the text, each chunk is read to where the translated text will end up (or one byte
+	// beyond it, see below), and translated in place.  Throughput of the reads themselves is unaffected
+	// because FILE_FLAG_SEQUENTIAL_SCAN causes the OS to read ahead of each request.
+	#define FILEREAD_CHUNK_SIZE (4 * 1024 * 1024)
+	DWORD bytes_actually_read, chunk_size, chunk_bytes_read;
+	char *write_pos = output_buf, *read_pos, *chunk_end, *cr;
+	bool cr_is_pending = false; // Whether the previous chunk ended in a CR that might be the first half of a CRLF.
+	BOOL result = TRUE;
+	for (bytes_actually_read = 0; bytes_actually_read < (DWORD)bytes_to_read; bytes_actually_read += chunk_bytes_read)
+	{
+		chunk_size = (DWORD)bytes_to_read - bytes_actually_read;
+		if (chunk_size > FILEREAD_CHUNK_SIZE)
+			chunk_size = FILEREAD_CHUNK_SIZE;
+		// A pending CR hasn't been written yet, so leave room for it.  This can't overflow the buffer because
+		// the total written (including the CR) never exceeds the total read.
+		read_pos = write_pos + cr_is_pending;
+		if (   !(result = ReadFile(hfile, read_pos, chunk_size, &chunk_bytes_read, NULL)) || !chunk_bytes_read   )
+			break; // Error or unexpected end of file (e.g. file was truncated by another process since its size was determined).
+		if (!translate_crlf_to_lf)
+		{
+			write_pos += chunk_bytes_read;
+			continue;
+		}
+		chunk_end = read_pos + chunk_bytes_read;
+		if (cr_is_pending)
+		{
+			cr_is_pending = false;
+			if (*read_pos == '\n') // The CR was the first half of a CRLF, so omit it.
+				*write_pos++ = *read_pos++;
+			else
+				*write_pos++ = '\r';
+		}
+		// Copy each run of text between CRLFs down to write_pos.  memchr() is used for the scanning because
+		// the CRT's implementation examines several bytes at a time.
+		while (read_pos < chunk_end)
+		{
+			if (   !(cr = (char *)memchr(read_pos, '\r', chunk_end - read_pos))   )
+				cr = chunk_end;
+			if (write_pos != read_pos)
+				memmove(write_pos, read_pos, cr - read_pos);
+			write_pos += cr - read_pos;
+			if (cr == chunk_end)
+				break;
+			if (cr + 1 == chunk_end) // CR at the very end of the chunk: whether it's omitted depends on the next chunk.
+			{
+				cr_is_pending = true;
+				break;
+			}
+			if (cr[1] == '\n') // Omit the CR of this CRLF.
+			{
+				*write_pos++ = '\n';
+				read_pos = cr + 2;
+			}
+			else // Lone CR, so retain it.
+			{
+				*write_pos++ = '\r';
+				read_pos = cr + 1;
+			}
+		}
+	}
+	if (cr_is_pending) // The file (or the portion being loaded) ended in CR.
+		*write_pos++ = '\r';
 	CloseHandle(hfile);
 
 	// Upon result==success, bytes_actually_read is not checked against bytes_to_read because it
@@ -8754,13 +9045,8 @@ ResultType Line::FileRead(char *aFilespec)
 
 	if (result)
 	{
-		output_buf[bytes_actually_read] = '\0';  // Ensure text is terminated where indicated.
-		// Since a larger string is being replaced with a smaller, there's a good chance the 2 GB
-		// address limit will not be exceeded by StrReplace even if the file is close to the
-		// 1 GB limit as described above:
-		if (translate_crlf_to_lf)
-			StrReplace(output_buf, "\r\n", "\n", SCS_SENSITIVE); // Safe only because larger string is being replaced with smaller.
-		output_var.Length() = is_binary_clipboard ? (bytes_actually_read - 1) // Length excludes the very last byte of the (UINT)0 terminator.
+		*write_pos = '\0';  // Ensure text is terminated where indicated.
+		output_var.Length() = is_binary_clipboard ? (VarSizeType)(write_pos - output_buf - 1) // Length excludes the very last byte of the (UINT)0 terminator.
 			: (VarSizeType)strlen(output_buf); // In case file contains binary zeroes, explicitly calculate the "usable" length so that it's accurate.
 	}
 	else
@@ -8870,10 +9156,18 @@ ResultType Line::FileAppend(char *aFilespec, char *aBuf, LoopReadFileStruct *aCu
 		//    (which helps performance).
 		if (ARGVAR1)
 		{
+			// Both of the following overwrite the file, so first write out and close any cached handle
+			// to it.  Otherwise, text still in that handle's buffer would be appended after the new contents:
 			if (ARGVAR1->Type() == VAR_CLIPBOARDALL)
+			{
+				if (sFileAppendCacheCount)
+					FileAppendCacheClose(aFilespec);
 				return WriteClipboardToFile(aFilespec);
+			}
 			else if (ARGVAR1->IsBinaryClip())
 			{
+				if (sFileAppendCacheCount)
+					FileAppendCacheClose(aFilespec);
 				// Since there is at least one deref in Arg #1 and the first deref is binary clipboard,
 				// assume this operation's only purpose is to write binary data from that deref to a file.
 				// This is because that's the only purpose that seems useful and that's currently supported.
@@ -8909,12 +9203,19 @@ ResultType Line::FileAppend(char *aFilespec, char *aBuf, LoopReadFileStruct *aCu
 	// 2) To avoid opening the file if the file-reading loop has zero iterations (i.e. it's
 	//    opened only upon first actual use to help performance and avoid changing the
 	//    file-modification time when no actual text will be appended).
+	FileAppendCacheStruct *cached_file = NULL;
 	if (!file_was_already_open)
 	{
 		// Open the output file (if one was specified).  Unlike the input file, this is not
 		// a critical error if it fails.  We want it to be non-critical so that FileAppend
-		// commands in the body of the loop will set ErrorLevel to indicate the problem:
-		if (   !(fp = fopen(aFilespec, open_as_binary ? "ab" : "a"))   )
+		// commands in the body of the loop will set ErrorLevel to indicate the problem.
+		// Outside of a file-reading loop, the file is kept open in the cache so that a series
+		// of appends to the same file (e.g. a log) costs one open rather than one per call:
+		if (aCurrentReadFile || strlen(aFilespec) >= MAX_PATH) // Too long to cache (probably too long for fopen() too, but let it decide).
+			fp = fopen(aFilespec, open_as_binary ? "ab" : "a");
+		else if (cached_file = FileAppendCacheOpen(aFilespec, open_as_binary))
+			fp = cached_file->mFile;
+		if (!fp)
 			return g_ErrorLevel->Assign(ERRORLEVEL_ERROR);
 		if (aCurrentReadFile)
 			aCurrentReadFile->mWriteFile = fp;
@@ -8923,7 +9224,18 @@ ResultType Line::FileAppend(char *aFilespec, char *aBuf, LoopReadFileStruct *aCu
 	// Write to the file:
 	g_ErrorLevel->Assign(fputs(aBuf, fp) ? ERRORLEVEL_ERROR : ERRORLEVEL_NONE); // fputs() returns 0 on success.
 
-	if (!aCurrentReadFile)
+	if (cached_file)
+	{
+		// Write the text through to disk now rather than leaving it in the buffer.  This makes ErrorLevel
+		// reflect the actual write, keeps the text from being lost if the script hangs or crashes, and lets
+		// anything else reading the file (e.g. tail -f style) see it right away.  Since the buffer is large
+		// and starts out empty, each FileAppend's text (unless it's huge) reaches the file in a single write,
+		// so other processes appending to the same file can't interleave partial lines with it.  Keeping the
+		// file open still avoids the cost of opening and closing it for each call:
+		if (fflush(fp))
+			g_ErrorLevel->Assign(ERRORLEVEL_ERROR);
+	}
+	else if (!aCurrentReadFile)
 		fclose(fp);
 	// else it's the caller's responsibility, or it's caller's, to close it.
 
@@ -8932,6 +9244,91 @@ ResultType Line::FileAppend(char *aFilespec, char *aBuf, LoopReadFileStruct *aCu
 
 
 
+FileAppendCacheStruct Line::sFileAppendCache[FILE_APPEND_CACHE_SIZE]; // No init needed.
+int Line::sFileAppendCacheCount = 0;
+
+FileAppendCacheStruct *Line::FileAppendCacheOpen(char *aFilespec, bool aBinary)
+// Returns the cache entry holding aFilespec open for appending, opening it (and evicting the least
+// recently used file if the cache is full) if necessary.  Returns NULL if the file can't be opened.
+// Caller must have ensured that aFilespec is shorter than MAX_PATH.
+// Files are matched by the name the script used, so relative names rely on the cache being closed
+// whenever the working directory might change (see ACT_CLOSES_FILE_APPEND_CACHE).
+{
+	DWORD now = GetTickCount();
+	FileAppendCacheStruct *entry;
+	int i, slot = -1;
+
+	for (i = 0; i < sFileAppendCacheCount; ++i)
+	{
+		entry = sFileAppendCache + i;
+		if (!stricmp(entry->mFileName, aFilespec))
+		{
+			if (entry->mBinary == aBinary)
+			{
+				entry->mLastUsed = now;
+				return entry;
+			}
+			// Otherwise, the same file is wanted in the other mode (binary vs. text).  Close it rather
+			// than having two handles to it, since text buffered in one would then be written to disk
+			// out of order with respect to text buffered in the other:
+			fclose(entry->mFile);
+			slot = i;
+			break;
+		}
+	}
+
+	if (slot < 0) // It's not in the cache.
+	{
+		if (sFileAppendCacheCount < FILE_APPEND_CACHE_SIZE)
+			slot = sFileAppendCacheCount; // Use the next unused entry (the count is incremented only upon success).
+		else // Evict the least recently used file.
+		{
+			for (slot = 0, i = 1; i < sFileAppendCacheCount; ++i)
+				if (now - sFileAppendCache[i].mLastUsed > now - sFileAppendCache[slot].mLastUsed)
+					slot = i;
+			fclose(sFileAppendCache[slot].mFile);
+		}
+	}
+
+	FILE *fp = fopen(aFilespec, aBinary ? "ab" : "a");
+	if (!fp)
+	{
+		if (slot < sFileAppendCacheCount) // The entry at slot was closed above, so remove it by moving the last one into its place.
+			sFileAppendCache[slot] = sFileAppendCache[--sFileAppendCacheCount];
+		return NULL;
+	}
+	// The CRT's default buffer is only 4 KB, so use a larger one to reduce the number of writes
+	// for scripts that append a lot of text.  The CRT allocates it and frees it upon fclose():
+	setvbuf(fp, NULL, _IOFBF, FILE_APPEND_BUF_SIZE);
+
+	entry = sFileAppendCache + slot;
+	entry->mFile = fp;
+	entry->mLastUsed = now;
+	entry->mBinary = aBinary;
+	strcpy(entry->mFileName, aFilespec); // Caller has ensured it fits.
+	if (slot == sFileAppendCacheCount)
+		++sFileAppendCacheCount;
+	return entry;
+}
+
+
+
+void Line::FileAppendCacheClose(char *aFilespec)
+// Closes the files FileAppend is holding open so that they're no longer held open by the script
+// (e.g. so that they can be deleted or renamed).  If aFilespec isn't NULL, only that
+// file is closed (in either mode, since the cache can't have it open in both).
+{
+	for (int i = sFileAppendCacheCount - 1; i >= 0; --i) // Backward so that removing an entry doesn't skip any.
+	{
+		if (aFilespec && stricmp(sFileAppendCache[i].mFileName, aFilespec))
+			continue;
+		fclose(sFileAppendCache[i].mFile); // This also flushes it.
+		sFileAppendCache[i] = sFileAppendCache[--sFileAppendCacheCount]; // Move the last entry into its place.
+	}
+}
+
+
+
 ResultType Line::WriteClipboardToFile(char *aFilespec)
 // Returns OK or FAIL.  If OK, it sets ErrorLevel to the appropriate result.
 // If the clipboard is empty, a zero length file will be written, which seems best for its consistency.
@@ -9427,7 +9824,7 @@ int Line::FileSetAttrib(char *aAttributes, char *aFilePattern, FileLoopModeType
 		// MSDN confirms this in a vague way: "In the ANSI version of FindFirstFile(), [plpFileName] is
 		// limited to MAX_PATH characters."
 		strcpy(append_pos, "*.*"); // Above has ensured this won't overflow.
-		file_search = FindFirstFile(file_path, &current_file);
+		file_search = FindFirstFileBatched(file_path, current_file, true); // Only folders are of interest here.
 
 		if (file_search != INVALID_HANDLE_VALUE)
 		{
@@ -9658,7 +10055,7 @@ int Line::FileSetTime(char *aYYYYMMDD, char *aFilePattern, char aWhichTime
 		// MSDN confirms this in a vague way: "In the ANSI version of FindFirstFile(), [plpFileName] is
 		// limited to MAX_PATH characters."
 		strcpy(append_pos, "*.*"); // Above has ensured this won't overflow.
-		file_search = FindFirstFile(file_path, &current_file);
+		file_search = FindFirstFileBatched(file_path, current_file, true); // Only folders are of interest here.
 
 		if (file_search != INVALID_HANDLE_VALUE)
 		{
@@ -11767,6 +12164,10 @@ void BIF_DllCall(ExprTokenType &aResultToken, ExprTokenType *aParam[], int aPara
 	HMODULE hmodule_to_free = NULL; // Set default in case of early goto; mostly for maintainability.
 	void *function; // Will hold the address of the function to be called.
 
+	// The function might operate on a file FileAppend is holding open (e.g. MoveFile to rotate a log):
+	if (Line::sFileAppendCacheCount)
+		Line::FileAppendCacheClose();
+
 	// Check that the mandatory first parameter (DLL+Function) is valid.
 	// (load-time validation has ensured at least one parameter is present).
 	switch(aParam[0]->symbol)
@@ -13723,12 +14124,62 @@ void BIF_VarSetCapacity(ExprTokenType &aResultToken, ExprTokenType *aParam[], in
 
 
 
+void BIF_RandomFill(ExprTokenType &aResultToken, ExprTokenType *aParam[], int aParamCount)
+// Returns: The number of random integers stored, or 0 on failure.
+// Parameters:
+// 1: Target variable (unquoted), which receives the integers in binary form, 4 bytes each (for use with NumGet).
+// 2: How many integers to generate.
+// 3: Min and 4: Max, which work the same as those of the Random command.  If both are omitted, each
+//    integer is the full unsigned 32-bit output of the generator.
+// This is much faster than calling Random in a loop for scripts that need a great many random numbers.
+// The numbers are the same as the corresponding series of Random commands would produce, so seeding
+// via "Random,, NewSeed" makes the results just as reproducible.
+{
+	aResultToken.value_int64 = 0; // Set default.
+	if (aParam[0]->symbol != SYM_VAR) // SYM_VAR's Type() is always VAR_NORMAL (except lvalues in expressions).
+		return;
+	Var &var = *aParam[0]->var;
+	__int64 count = TokenToInt64(*aParam[1]);
+	if (count < 1 || count > (VARSIZE_MAX - 1) / sizeof(UINT)) // -1 to leave room for the terminator.
+		return;
+	VarSizeType size = (VarSizeType)count * sizeof(UINT);
+	if (!var.Assign(NULL, size, true, false)) // This also destroys the variable's contents.  false = don't obey #MaxMem, like VarSetCapacity().
+		return;
+	char *contents = var.Contents();
+	UINT *number = (UINT *)contents;
+	genrand_int32_fill((unsigned long *)number, (size_t)count);
+
+	if (aParamCount > 2) // Min and/or Max is present, so convert each number to that range the same way as ACT_RANDOM.
+	{
+		char buf[MAX_NUMBER_SIZE];
+		int rand_min = *TokenToString(*aParam[2], buf) ? (int)TokenToInt64(*aParam[2]) : 0;
+		int rand_max = (aParamCount > 3 && *TokenToString(*aParam[3], buf)) ? (int)TokenToInt64(*aParam[3]) : INT_MAX;
+		if (rand_min > rand_max)
+		{
+			int rand_swap = rand_min;
+			rand_min = rand_max;
+			rand_max = rand_swap;
+		}
+		__int64 range = (__int64)rand_max - rand_min + 1;
+		for (__int64 i = 0; i < count; ++i)
+			number[i] = (UINT)(int)(__int64(number[i] % range) + rand_min); // See ACT_RANDOM for comments.
+	}
+
+	contents[size] = '\0'; // Must terminate because nothing else is explicitly reponsible for doing it.
+	var.Length() = size;
+	aResultToken.value_int64 = count;
+}
+
+
+
 void BIF_FileExist(ExprTokenType &aResultToken, ExprTokenType *aParam[], int aParamCount)
 {
 	char filename_buf[MAX_NUMBER_SIZE]; // Because aResultToken.buf is used for something else below.
 	char *filename = TokenToString(*aParam[0], filename_buf);
 	aResultToken.marker = aResultToken.buf; // If necessary, it will be moved to a persistent memory location by our caller.
 	aResultToken.symbol = SYM_STRING;
+	if (Line::sFileAppendCacheCount) // See ACT_IFEXIST.
+		Line::FileAppendCacheClose();
 	DWORD attr;
 	if (DoesFilePatternExist(filename, &attr))
 	{
@@ -14124,6 +14575,7 @@ void BIF_OnMessage(ExprTokenType &aResultToken, ExprTokenType *aParam[], int aPa
 			// The main disadvantage to deleting message filters from the array is that the deletion might
 			// occur while the monitor is currently running, which requires more complex handling within
 			// MsgMonitor() (see its comments for details).
+			MSG_MONITOR_FILTER_CLEAR(specified_msg);
 			--g_MsgMonitorCount;  // Must be done prior to the below.
 			if (msg_index < g_MsgMonitorCount) // An element other than the last is being removed. Shift the array to cover/delete it.
 				MoveMemory(g_MsgMonitor+msg_index, g_MsgMonitor+msg_index+1, sizeof(MsgMonitorStruct)*(g_MsgMonitorCount-msg_index));
@@ -14144,6 +14596,7 @@ void BIF_OnMessage(ExprTokenType &aResultToken, ExprTokenType *aParam[], int aPa
 			return; // Indicate failure by yielding the default return value set earlier.
 		// Otherwise, the message is to be added, so increment the total:
 		++g_MsgMonitorCount;
+		MSG_MONITOR_FILTER_SET(specified_msg);
 		strcpy(buf, func->mName); // Yield the NEW name as an indicator of success. Caller has ensured that buf large enough to support max function name.
 		aResultToken.marker = buf;
 		monitor.instance_count = 0; // Reset instance_count only for new items since existing items might currently be running.
@@ -14625,6 +15078,13 @@ void BIF_LV_GetText(ExprTokenType &aResultToken, ExprTokenType *aParam[], int aP
 		else // On failure, it seems best to also clear the output var for better consistency and in case the script doesn't check the return value.
 			output_var.Assign();
 	}
+	else if (lv_virtual_type *virt = gui.mCurrentListView->union_lv_attrib->virt) // Virtual ListView, so get it directly.
+	{
+		if (aResultToken.value_int64 = (row_index < virt->row_count)) // Assign.
+			output_var.Assign(GuiType::LV_VirtualGetText(*virt, row_index, col_index));
+		else
+			output_var.Assign();
+	}
 	else // Get row's indicated item or subitem text.
 	{
 		LVITEM lvi;
@@ -14812,13 +15272,69 @@ void BIF_LV_AddInsertModify(ExprTokenType &aResultToken, ExprTokenType *aParam[]
 		*option_end = orig_char; // Undo the temporary termination because the caller needs aOptions to be unaltered.
 	}
 
+	int i, j, rows_to_change;
+
+	if (lv_virtual_type *virt = control.union_lv_attrib->virt) // Virtual ListView: the text is stored by us rather than the control.
+	{
+		// Checkmarks and icons aren't supported because the control doesn't store them in this mode.
+		int first_row, last_row;
+		if (mode == 'I')
+		{
+			if (   (first_row = last_row = GuiType::LV_VirtualInsertRow(*virt, index)) < 0   )
+				return; // Out of memory.
+			aResultToken.value_int64 = first_row + 1; // +1 to convert to one-based.
+		}
+		else
+		{
+			if (index == -1) // Modify all rows.
+			{
+				first_row = 0;
+				last_row = virt->row_count - 1;
+				ensure_visible = false; // Not applicable when operating on all rows.
+			}
+			else if (index < virt->row_count)
+				first_row = last_row = index;
+			else
+				return; // Row doesn't exist.
+			aResultToken.value_int64 = 1;
+		}
+		// Parameter #2 onward are the fields, starting at column col_start_index (see the non-virtual
+		// section below for details):
+		for (j = first_row; j <= last_row; ++j)
+			for (i = 1; i < aParamCount; ++i)
+				if (!GuiType::LV_VirtualSetText(*virt, j, col_start_index + i - 1, TokenToString(*aParam[i], buf)) && mode != 'I')
+					aResultToken.value_int64 = 0; // Indicate partial failure (see similar section below).
+		if (mode == 'I')
+		{
+			// Use LVM_INSERTITEM rather than LVM_SETITEMCOUNT so that the control shifts the selection and
+			// focus of the rows below the new one, just as LVM_DELETEITEM does for LV_Delete().  In owner-data
+			// mode, only iItem is used; the control just adds one to its row count (and redraws as needed):
+			LVITEM lvi_insert;
+			lvi_insert.mask = 0;
+			lvi_insert.iItem = first_row;
+			lvi_insert.iSubItem = 0;
+			if (ListView_InsertItem(control.hwnd, &lvi_insert) == -1) // Keep the control in sync with the stored rows.
+			{
+				GuiType::LV_VirtualDeleteRow(*virt, first_row);
+				aResultToken.value_int64 = 0;
+				return;
+			}
+		}
+		else if (last_row >= first_row)
+			ListView_RedrawItems(control.hwnd, first_row, last_row);
+		if (lvi.stateMask & (LVIS_SELECTED | LVIS_FOCUSED))
+			ListView_SetItemState(control.hwnd, index == -1 ? -1 : first_row, lvi.state, lvi.stateMask & (LVIS_SELECTED | LVIS_FOCUSED)); // -1 means all rows.
+		if (ensure_visible)
+			SendMessage(control.hwnd, LVM_ENSUREVISIBLE, first_row, FALSE);
+		return;
+	}
+
 	// More maintainable and performs better to have a separate struct for subitems vs. items.
 	LVITEM lvi_sub;
 	// Ensure mask is pure to avoid giving it any excuse to fail due to the fact that
 	// "You cannot set the state or lParam members for subitems."
 	lvi_sub.mask = LVIF_TEXT;
 
-	int i, j, rows_to_change;
 	if (index == -1) // Modify all rows (above has ensured that this is only happens in modify-mode).
 	{
 		rows_to_change = ListView_GetItemCount(control.hwnd);
@@ -14906,6 +15422,118 @@ void BIF_LV_AddInsertModify(ExprTokenType &aResultToken, ExprTokenType *aParam[]
 
 
 
+void BIF_LV_AddMany(ExprTokenType &aResultToken, ExprTokenType *aParam[], int aParamCount)
+// Returns: The number of rows added (0 on failure).
+// Parameters:
+// 1: The rows to add, delimited by linefeeds (an optional carriage return before each linefeed is omitted).
+//    A trailing linefeed at the very end does not produce an extra blank row.
+// 2: The character that separates the fields within each row (default: tab).  Fields beyond the number of
+//    columns are ignored by the control (see LV_Add()).
+// Compared to calling LV_Add() once per row, this avoids the overhead of expression evaluation and option
+// parsing for every row, pre-sizes the control via LVM_SETITEMCOUNT, and suspends redrawing until all rows
+// have been added.  This makes it practical to load tens of thousands of rows at once.
+{
+	char *buf = aResultToken.buf; // Must be saved early since below overwrites the union (better maintainability too).
+	aResultToken.value_int64 = 0; // Set default return value.
+
+	if (!g_gui[g->GuiDefaultWindowIndex])
+		return;
+	GuiType &gui = *g_gui[g->GuiDefaultWindowIndex]; // Always operate on thread's default window to simplify the syntax.
+	if (!gui.mCurrentListView)
+		return;
+	GuiControlType &control = *gui.mCurrentListView;
+
+	char *rows = TokenToString(*aParam[0], buf);
+	if (!*rows)
+		return;
+	// Make a modifiable copy so that each field can be terminated in place rather than copied individually.
+	// This also protects against the script's variable being altered by a notification (e.g. the control's
+	// g-label) during the inserts below:
+	size_t rows_length = strlen(rows);
+	char *rows_copy = (char *)malloc(rows_length + 1);
+	if (!rows_copy)
+		return;
+	memcpy(rows_copy, rows, rows_length + 1);
+
+	char delimiter = '\t';
+	if (aParamCount > 1)
+	{
+		char *cp = TokenToString(*aParam[1], buf); // Safe to reuse buf now that "rows" has been copied.
+		if (*cp)
+			delimiter = *cp;
+	}
+
+	if (rows_copy[rows_length - 1] == '\n') // Omit the trailing newline so that it doesn't produce a blank row.
+		rows_copy[--rows_length] = '\0';
+
+	int row_count = 1; // Even an empty string (which can only happen here if rows was a lone linefeed) is one blank row.
+	char *cp, *row, *row_end, *field, *field_end;
+	for (cp = rows_copy; cp = strchr(cp, '\n'); ++cp) // Assign.
+		++row_count;
+
+	// For performance, disable redrawing and tell the control how many rows it will have so that it can
+	// allocate its internal structures once rather than growing them repeatedly:
+	lv_virtual_type *virt = control.union_lv_attrib->virt;
+	if (!control.redraw_off) // Otherwise, the script or "Gui BeginUpdate" has already turned it off and will turn it back on.
+		SendMessage(control.hwnd, WM_SETREDRAW, FALSE, 0);
+	if (virt) // For a virtual ListView, LVM_SETITEMCOUNT would create the rows, so it's done only after they've been stored.
+		GuiType::LV_VirtualReserve(*virt, row_count, rows_length); // Failure is detected below.
+	else
+		SendMessage(control.hwnd, LVM_SETITEMCOUNT, ListView_GetItemCount(control.hwnd) + row_count, 0);
+
+	LVITEM lvi, lvi_sub;
+	lvi.mask = LVIF_TEXT;
+	lvi.iSubItem = 0;
+	lvi_sub.mask = LVIF_TEXT; // See BIF_LV_AddInsertModify() for why a separate struct is used for subitems.
+	int rows_added = 0;
+
+	for (row = rows_copy; row; row = row_end)
+	{
+		if (row_end = strchr(row, '\n')) // Assign.
+		{
+			if (row_end > row && row_end[-1] == '\r')
+				row_end[-1] = '\0';
+			*row_end++ = '\0'; // Terminate this row and point row_end to the start of the next.
+		}
+		if (field_end = strchr(row, delimiter)) // Assign.
+			*field_end = '\0';
+		lvi.iItem = INT_MAX; // Append (see BIF_LV_AddInsertModify()).
+		lvi.pszText = row;
+		if (virt)
+		{
+			if (   (lvi_sub.iItem = GuiType::LV_VirtualInsertRow(*virt, INT_MAX)) < 0   )
+				break; // Out of memory, so stop here rather than trying the rest.
+			GuiType::LV_VirtualSetText(*virt, lvi_sub.iItem, 0, row);
+		}
+		else if (   (lvi_sub.iItem = ListView_InsertItem(control.hwnd, &lvi)) == -1   )
+			break; // Probably out of memory, so stop here rather than trying the rest.
+		++rows_added;
+		for (lvi_sub.iSubItem = 1; field_end; ++lvi_sub.iSubItem)
+		{
+			field = field_end + 1;
+			if (field_end = strchr(field, delimiter)) // Assign.
+				*field_end = '\0';
+			lvi_sub.pszText = field;
+			if (virt)
+				GuiType::LV_VirtualSetText(*virt, lvi_sub.iItem, lvi_sub.iSubItem, field);
+			else
+				ListView_SetItem(control.hwnd, &lvi_sub);
+		}
+	}
+
+	free(rows_copy);
+	if (virt)
+		ListView_SetItemCountEx(control.hwnd, virt->row_count, LVSICF_NOSCROLL);
+	if (!control.redraw_off) // Only turn redrawing back on if it was turned off above.
+	{
+		SendMessage(control.hwnd, WM_SETREDRAW, TRUE, 0);
+		InvalidateRect(control.hwnd, NULL, TRUE); // MSDN: WM_SETREDRAW doesn't by itself repaint the control.
+	}
+	aResultToken.value_int64 = rows_added;
+}
+
+
+
 void BIF_LV_Delete(ExprTokenType &aResultToken, ExprTokenType *aParam[], int aParamCount)
 // Returns: 1 on success and 0 on failure.
 // Parameters:
@@ -14924,9 +15552,12 @@ void BIF_LV_Delete(ExprTokenType &aResultToken, ExprTokenType *aParam[], int aPa
 	if (!gui.mCurrentListView)
 		return;
 	HWND control_hwnd = gui.mCurrentListView->hwnd;
+	lv_virtual_type *virt = gui.mCurrentListView->union_lv_attrib->virt; // For virtual ListViews, the stored rows must be kept in sync with the control's row count.
 
 	if (aParamCount < 1)
 	{
+		if (virt)
+			GuiType::LV_VirtualDeleteAll(*virt);
 		aResultToken.value_int64 = SendMessage(control_hwnd, LVM_DELETEALLITEMS, 0, 0); // Returns TRUE/FALSE.
 		return;
 	}
@@ -14934,7 +15565,15 @@ void BIF_LV_Delete(ExprTokenType &aResultToken, ExprTokenType *aParam[], int aPa
 	// Since above didn't return, there is a first paramter present.
 	int index = (int)TokenToInt64(*aParam[0]) - 1; // -1 to convert to zero-based.
 	if (index > -1)
+	{
+		if (virt)
+		{
+			if (index >= virt->row_count)
+				return;
+			GuiType::LV_VirtualDeleteRow(*virt, index);
+		}
 		aResultToken.value_int64 = SendMessage(control_hwnd, LVM_DELETEITEM, index, 0); // Returns TRUE/FALSE.
+	}
 	//else even if index==0, for safety, it seems not to do a delete-all.
 }
 
@@ -15002,6 +15641,8 @@ void BIF_LV_InsertModifyDeleteCol(ExprTokenType &aResultToken, ExprTokenType *aP
 				--lv_attrib.col_count; // Must be done prior to the below.
 			if (index < lv_attrib.col_count) // When a column other than the last was removed, adjust the array so that it stays in sync with actual columns.
 				MoveMemory(lv_attrib.col+index, lv_attrib.col+index+1, sizeof(lv_col_type)*(lv_attrib.col_count-index));
+			if (lv_attrib.virt)
+				GuiType::LV_VirtualInsertDeleteCol(*lv_attrib.virt, index, false);
 		}
 		return;
 	}
@@ -15050,6 +15691,7 @@ void BIF_LV_InsertModifyDeleteCol(ExprTokenType &aResultToken, ExprTokenType *aP
 	int do_auto_size = (mode == 'I') ? LVSCW_AUTOSIZE_USEHEADER : 0;  // Default to auto-size for new columns.
 	char sort_now_direction = 'A'; // Ascending.
 	int new_justify = lvc.fmt & LVCFMT_JUSTIFYMASK; // Simplifies the handling of the justification bitfield.
+	UCHAR old_type = col.type; // For detecting a change of type below.
 	//lvc.iSubItem = 0; // Not necessary if the LVCF_SUBITEM mask-bit is absent.
 
 	// Parse list of space-delimited options:
@@ -15191,6 +15833,15 @@ void BIF_LV_InsertModifyDeleteCol(ExprTokenType &aResultToken, ExprTokenType *aP
 	// Apply any changed justification/alignment to the fmt bit field:
 	lvc.fmt = (lvc.fmt & ~LVCFMT_JUSTIFYMASK) | new_justify;
 
+	// If this is a virtual ListView, discard any numbers cached for sorting this column because they
+	// were converted according to its old type (e.g. integer keys would be wrong for a Float column).
+	// They will be rebuilt by the next sort:
+	if (mode == 'M' && col.type != old_type && lv_attrib.virt && lv_attrib.virt->number[index])
+	{
+		free(lv_attrib.virt->number[index]);
+		lv_attrib.virt->number[index] = NULL;
+	}
+
 	if (aParamCount > 2) // Parameter #3 (text) is present.
 	{
 		lvc.pszText = TokenToString(*aParam[2], buf);
@@ -15235,6 +15886,8 @@ void BIF_LV_InsertModifyDeleteCol(ExprTokenType &aResultToken, ExprTokenType *aP
 		// column: The new first column inherit's the old column's values (fields), so it seems best to also have it
 		// inherit the old column's attributs.
 		++lv_attrib.col_count; // New column successfully added.  Must be done only after the MoveMemory() above.
+		if (lv_attrib.virt)
+			GuiType::LV_VirtualInsertDeleteCol(*lv_attrib.virt, index, true);
 	}
 
 	// Auto-size is done only at this late a stage, in case column was just created above.
@@ -15555,6 +16208,241 @@ void BIF_TV_AddModifyDelete(ExprTokenType &aResultToken, ExprTokenType *aParam[]
 
 
 
+// Each tv_pending_type allocated by TV_AddLines() is recorded in the following table along with the TreeView
+// and item it belongs to, and the item's lParam holds the (one-based) index of its slot.  This allows an
+// lParam to be recognized as one of ours by comparing it against the table rather than by dereferencing it,
+// which matters because the script can set an item's lParam to anything (e.g. via SendMessage TVM_SETITEM).
+struct tv_pending_slot_type
+{
+	HWND tree;                // NULL if the slot is unused.
+	HTREEITEM item;
+	tv_pending_type *pending;
+	int next_free;            // For an unused slot: the index of the next unused slot, or -1 if none.
+};
+static tv_pending_slot_type *sTVPending = NULL;
+static int sTVPendingCount = 0, sTVPendingCapacity = 0, sTVPendingFree = -1;
+
+static int TV_AddPending(HWND aTreeHwnd, tv_pending_type *aPending)
+// Returns the index of the slot that now holds aPending, or -1 if out of memory.  The caller must fill in
+// the slot's item once the item has been created.
+{
+	int slot;
+	if (sTVPendingFree > -1) // Reuse an unused slot.
+	{
+		slot = sTVPendingFree;
+		sTVPendingFree = sTVPending[slot].next_free;
+	}
+	else
+	{
+		if (sTVPendingCount == sTVPendingCapacity)
+		{
+			int new_capacity = sTVPendingCapacity ? sTVPendingCapacity * 2 : 64;
+			// Use a temp var. because realloc() returns NULL on failure but leaves original block allocated.
+			tv_pending_slot_type *new_mem;
+			if (   !(new_mem = (tv_pending_slot_type *)realloc(sTVPending, new_capacity * sizeof(tv_pending_slot_type)))   )
+				return -1;
+			sTVPending = new_mem;
+			sTVPendingCapacity = new_capacity;
+		}
+		slot = sTVPendingCount++;
+	}
+	sTVPending[slot].tree = aTreeHwnd;
+	sTVPending[slot].item = NULL;
+	sTVPending[slot].pending = aPending;
+	return slot;
+}
+
+static void TV_RemovePending(int aSlot)
+{
+	sTVPending[aSlot].tree = NULL;
+	sTVPending[aSlot].pending = NULL;
+	sTVPending[aSlot].next_free = sTVPendingFree;
+	sTVPendingFree = aSlot;
+}
+
+tv_pending_type *TV_TakePending(HWND aTreeHwnd, HTREEITEM aItem, LPARAM aParam)
+// If aParam is the lParam that TV_AddLines() gave aItem, returns the item's tv_pending_type after removing
+// it from the table (the caller is responsible for freeing it).  Otherwise, returns NULL.
+{
+	if (aParam < 1 || aParam > sTVPendingCount)
+		return NULL;
+	int slot = (int)aParam - 1;
+	if (sTVPending[slot].tree != aTreeHwnd || sTVPending[slot].item != aItem || !aTreeHwnd) // Not ours (perhaps set by the script).
+		return NULL;
+	tv_pending_type *pending = sTVPending[slot].pending;
+	TV_RemovePending(slot);
+	return pending;
+}
+
+void TV_FreeAllPending(HWND aTreeHwnd)
+// Frees the descendants of every lazily-added item of aTreeHwnd that was never expanded.  Called when the
+// control is destroyed, since it might not have notified us of the deletion of each item.
+{
+	for (int slot = 0; slot < sTVPendingCount; ++slot)
+	{
+		if (sTVPending[slot].tree == aTreeHwnd && aTreeHwnd)
+		{
+			free(sTVPending[slot].pending);
+			TV_RemovePending(slot);
+		}
+	}
+}
+
+
+
+int TV_AddLines(HWND aTreeHwnd, HTREEITEM aParent, char *aText, int aBaseDepth, bool aLazy)
+// Helper function for TV_AddMany() and for the expansion of items it added in lazy mode.
+// Adds one item for each line in aText (which is modified in place), using the number of leading tabs beyond
+// aBaseDepth as the item's depth beneath aParent.  A line indented more than one level deeper than the line
+// above it is treated as being only one level deeper.  Lines that are entirely blank are ignored.
+// If aLazy is true, only the top-level items are added.  The lines of each one's descendants are copied
+// into a tv_pending_type stored in the item's lParam, and are added only when the item is first expanded
+// (see TVN_ITEMEXPANDING).  Returns the number of items added.
+{
+	#define TV_MAX_LOAD_DEPTH 256
+	HTREEITEM parent[TV_MAX_LOAD_DEPTH + 1]; // The most recently added item at each depth, which serves as the parent of the depth below it.
+	parent[0] = aParent;
+	TVINSERTSTRUCT tvi;
+	tvi.hInsertAfter = TVI_LAST;
+	int depth, last_depth = -1, added_count = 0;
+	char *line, *line_end, *next_line, *text, *cp;
+	bool has_children;
+
+	for (line = aText; *line; line = next_line)
+	{
+		if (line_end = strchr(line, '\n')) // Assign.
+			next_line = line_end + 1;
+		else
+			next_line = line_end = line + strlen(line);
+		for (depth = 0, text = line; *text == '\t'; ++text, ++depth);
+		if (line_end > text && line_end[-1] == '\r')
+			--line_end;
+		if (text == line_end) // Blank line.
+			continue;
+		*line_end = '\0'; // Terminate this line's text.  Doesn't disturb next_line (see above).
+		depth -= aBaseDepth;
+		if (depth < 0)
+			depth = 0;
+		if (depth > last_depth + 1)
+			depth = last_depth + 1;
+		if (depth >= TV_MAX_LOAD_DEPTH)
+			depth = TV_MAX_LOAD_DEPTH - 1;
+
+		tvi.hParent = parent[depth];
+		tvi.item.mask = TVIF_TEXT;
+		tvi.item.pszText = text;
+		tv_pending_type *pending = NULL;
+		int pending_slot = -1;
+		if (aLazy)
+		{
+			// Find the end of this item's descendants, which is the next non-blank line that isn't indented
+			// deeper than this one:
+			for (has_children = false, cp = next_line; *cp; )
+			{
+				for (text = cp, depth = 0; *text == '\t'; ++text, ++depth);
+				if (*text != '\r' && *text != '\n' && *text) // Not a blank line.
+				{
+					if (depth <= aBaseDepth)
+						break;
+					has_children = true;
+				}
+				if (   !(cp = strchr(cp, '\n'))   )
+				{
+					cp = text + strlen(text); // Point it to the terminator of aText.
+					break;
+				}
+				++cp;
+			}
+			if (has_children)
+			{
+				if (pending = (tv_pending_type *)malloc(sizeof(tv_pending_type) + (cp - next_line))) // Assign. sizeof() includes room for the terminator.
+				{
+					if ((pending_slot = TV_AddPending(aTreeHwnd, pending)) < 0)
+					{
+						free(pending);
+						pending = NULL;
+					}
+					else
+					{
+						pending->base_depth = aBaseDepth + 1;
+						memcpy(pending->text, next_line, cp - next_line);
+						pending->text[cp - next_line] = '\0';
+						// Show an expansion button even though the item has no children yet:
+						tvi.item.mask |= TVIF_CHILDREN | TVIF_PARAM;
+						tvi.item.cChildren = 1;
+						tvi.item.lParam = pending_slot + 1; // +1 so that an lParam of zero is never ours.
+					}
+				}
+				//else out of memory, so just omit the descendants.
+			}
+			next_line = cp; // Skip over the descendants.
+			depth = 0; // In lazy mode, every item added by this call is a direct child of aParent.
+		}
+		if (   !(parent[depth + 1] = TreeView_InsertItem(aTreeHwnd, &tvi))   )
+		{
+			if (pending)
+			{
+				free(pending);
+				TV_RemovePending(pending_slot);
+			}
+			break; // Probably out of memory, so stop here rather than trying the rest.
+		}
+		if (pending)
+			sTVPending[pending_slot].item = parent[depth + 1];
+		last_depth = depth;
+		++added_count;
+	}
+	return added_count;
+}
+
+
+
+void BIF_TV_AddMany(ExprTokenType &aResultToken, ExprTokenType *aParam[], int aParamCount)
+// Returns: The number of items added (in lazy mode, only those at the top level count).
+// Parameters:
+// 1: The items to add, one per line.  Each line's depth in the tree is indicated by how many tabs it is
+//    indented (see TV_AddLines()).
+// 2: The parent beneath which to add the top-level items (default: root).
+// 3: Options: the word Lazy causes each item's children to be added only when the item is first expanded,
+//    which greatly reduces the time and memory needed to load large trees of which only a small portion
+//    is typically ever shown.
+// Compared to calling TV_Add() once per item, this avoids the overhead of expression evaluation and option
+// parsing for every item, and suspends redrawing until all items have been added.
+{
+	char *buf = aResultToken.buf; // Must be saved early since below overwrites the union (better maintainability too).
+	aResultToken.value_int64 = 0; // Set default return value.
+
+	if (!g_gui[g->GuiDefaultWindowIndex])
+		return;
+	GuiType &gui = *g_gui[g->GuiDefaultWindowIndex]; // Always operate on thread's default window to simplify the syntax.
+	if (!gui.mCurrentTreeView)
+		return;
+	GuiControlType &control = *gui.mCurrentTreeView;
+
+	// Make a modifiable copy so that each line can be terminated in place (see BIF_LV_AddMany() for details).
+	char *text = TokenToString(*aParam[0], buf);
+	size_t text_length = strlen(text);
+	char *text_copy = (char *)malloc(text_length + 1);
+	if (!text_copy)
+		return;
+	memcpy(text_copy, text, text_length + 1);
+
+	HTREEITEM parent = (aParamCount > 1) ? (HTREEITEM)TokenToInt64(*aParam[1]) : NULL;
+	bool lazy = (aParamCount > 2) && strcasestr(TokenToString(*aParam[2], buf), "Lazy"); // Safe to reuse buf now that text has been copied.
+
+	if (!control.redraw_off) // Otherwise, the script or "Gui BeginUpdate" has already turned it off and will turn it back on.
+		SendMessage(control.hwnd, WM_SETREDRAW, FALSE, 0);
+	aResultToken.value_int64 = TV_AddLines(control.hwnd, parent, text_copy, 0, lazy);
+	if (!control.redraw_off) // Only turn redrawing back on if it was turned off above.
+	{
+		SendMessage(control.hwnd, WM_SETREDRAW, TRUE, 0);
+		InvalidateRect(control.hwnd, NULL, TRUE); // MSDN: WM_SETREDRAW doesn't by itself repaint the control.
+	}
+	free(text_copy);
+}
+
+
+
 HTREEITEM GetNextTreeItem(HWND aTreeHwnd, HTREEITEM aItem)
 // Helper function for others below.
 // If aItem is NULL, caller wants topmost ROOT item returned.
@@ -16112,6 +17000,8 @@ int ConvertJoy(char *aBuf, int *aJoystickID, bool aAllowOnlyButtons)
 			return JOYCTRL_1 + offset - 1;
 		}
 	}
+	else // Since every valid name starts with "Joy", all others (i.e. most key names) can be ruled out now.
+		return JOYCTRL_INVALID;
 	if (aAllowOnlyButtons)
 		return JOYCTRL_INVALID;
 
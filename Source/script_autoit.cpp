@@ -2118,10 +2118,41 @@ void DoIncrementalMouseMove(int aX1, int aY1, int aX2, int aY2, int aSpeed)
 // PROCESS ROUTINES
 ////////////////////
 
-DWORD ProcessExist9x2000(char *aProcess, char *aProcessName)
+// The process table below caches the result of the most recent process snapshot for PROCESS_TABLE_TTL
+// milliseconds.  Taking a snapshot is far more expensive than searching one, and scripts often check for
+// several processes in a row (or have several timers and Process Wait/WaitClose loops polling at once),
+// so this allows all such checks within the same short interval to be satisfied by a single snapshot.
+// Each entry's name has already had its path removed so that lookups need only a stricmp().
+#define PROCESS_TABLE_TTL 50 // Short enough that a Process Wait loop (which polls every 100 ms) sees a fresh snapshot each time.
+struct ProcessTableEntry
 {
-	if (aProcessName) // Init this output variable in case of early return.
-		*aProcessName = '\0';
+	DWORD pid;
+	size_t name_offset; // Offset of the process's name (without path) in sProcessNames.
+};
+static ProcessTableEntry *sProcessTable = NULL;
+static int sProcessTableCount = 0, sProcessTableSize = 0;
+static char *sProcessNames = NULL;
+static size_t sProcessNamesSize = 0;
+static DWORD sProcessTableTime;
+static bool sProcessTableIsValid = false;
+
+
+
+void ProcessTableInvalidate()
+// Forces the next call to ProcessExist() to take a new snapshot.  This is called after the script itself
+// launches or terminates a process so that it never sees a table that predates its own actions.
+{
+	sProcessTableIsValid = false;
+}
+
+
+
+static bool ProcessTableUpdate()
+// Takes a new process snapshot unless the current one is still recent enough.
+// Returns false if no snapshot could be taken, in which case the table is empty.
+{
+	if (sProcessTableIsValid && GetTickCount() - sProcessTableTime < PROCESS_TABLE_TTL)
+		return true;
 
 	// We must dynamically load the function or program will probably not launch at all on NT4.
 	typedef BOOL (WINAPI *PROCESSWALK)(HANDLE hSnapshot, LPPROCESSENTRY32 lppe);
@@ -2131,48 +2162,95 @@ DWORD ProcessExist9x2000(char *aProcess, char *aProcessName)
     static PROCESSWALK lpfnProcess32First = (PROCESSWALK)GetProcAddress(GetModuleHandle("kernel32"), "Process32First");
     static PROCESSWALK lpfnProcess32Next = (PROCESSWALK)GetProcAddress(GetModuleHandle("kernel32"), "Process32Next");
 
+	sProcessTableIsValid = false;
+	sProcessTableCount = 0;
 	if (!lpfnCreateToolhelp32Snapshot || !lpfnProcess32First || !lpfnProcess32Next)
-		return 0;
+		return false;
 
 	PROCESSENTRY32 proc;
     proc.dwSize = sizeof(proc);
 	HANDLE snapshot = lpfnCreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+	if (snapshot == INVALID_HANDLE_VALUE)
+		return false;
+	// The first process is skipped because ProcessExist() has never searched it (it's the
+	// "System Idle Process", whose PID is zero).
 	lpfnProcess32First(snapshot, &proc);
 
-	// Determine the PID if aProcess is a pure, non-negative integer (any negative number
-	// is more likely to be the name of a process [with a leading dash], rather than the PID).
-	DWORD specified_pid = IsPureNumeric(aProcess) ? ATOU(aProcess) : 0;
 	char szDrive[_MAX_PATH+1], szDir[_MAX_PATH+1], szFile[_MAX_PATH+1], szExt[_MAX_PATH+1];
+	size_t names_length = 0, name_length;
 
 	while (lpfnProcess32Next(snapshot, &proc))
 	{
-		if (specified_pid && specified_pid == proc.th32ProcessID)
+		if (sProcessTableCount == sProcessTableSize)
 		{
-			if (aProcessName) // Caller wanted process name also.
-			{
-				// For consistency in results, use _splitpath() both here and below rather than
-				// something that just checks for a rightmost backslash.
-				_splitpath(proc.szExeFile, szDrive, szDir, aProcessName, szExt);
-				strcat(aProcessName, szExt);
-			}
-			CloseHandle(snapshot);
-			return specified_pid;
+			int new_size = sProcessTableSize ? sProcessTableSize * 2 : 256;
+			// Use a temp var. because realloc() returns NULL on failure but leaves original block allocated.
+			ProcessTableEntry *new_table = (ProcessTableEntry *)realloc(sProcessTable, new_size * sizeof(ProcessTableEntry));
+			if (!new_table)
+				break; // Search whatever was retrieved so far.
+			sProcessTable = new_table;
+			sProcessTableSize = new_size;
 		}
-		// Otherwise, check for matching name even if aProcess is purely numeric (i.e. a number might
-		// also be a valid name?):
 		// It seems that proc.szExeFile never contains a path, just the executable name.
-		// But in case it ever does, ensure consistency by removing the path:
+		// But in case it ever does, ensure consistency by removing the path.  For consistency
+		// in results, use _splitpath() rather than something that just checks for a rightmost
+		// backslash:
 		_splitpath(proc.szExeFile, szDrive, szDir, szFile, szExt);
 		strcat(szFile, szExt);
-		if (!stricmp(szFile, aProcess)) // lstrcmpi() is not used: 1) avoids breaking exisitng scripts; 2) provides consistent behavior across multiple locales; 3) performance.
+		name_length = strlen(szFile) + 1; // +1 for the terminator.
+		if (names_length + name_length > sProcessNamesSize)
 		{
-			if (aProcessName) // Caller wanted process name also.
-				strcpy(aProcessName, szFile);
-			CloseHandle(snapshot);
-			return proc.th32ProcessID;
+			size_t new_size = sProcessNamesSize ? sProcessNamesSize * 2 : 8192;
+			if (new_size < names_length + name_length) // Only possible if the initial size above is ever reduced.
+				new_size = names_length + name_length;
+			// Use a temp var. because realloc() returns NULL on failure but leaves original block allocated.
+			char *new_names = (char *)realloc(sProcessNames, new_size);
+			if (!new_names)
+				break; // Search whatever was retrieved so far.
+			sProcessNames = new_names;
+			sProcessNamesSize = new_size;
 		}
+		memcpy(sProcessNames + names_length, szFile, name_length);
+		sProcessTable[sProcessTableCount].pid = proc.th32ProcessID;
+		sProcessTable[sProcessTableCount].name_offset = names_length;
+		++sProcessTableCount;
+		names_length += name_length;
 	}
 	CloseHandle(snapshot);
+	sProcessTableTime = GetTickCount();
+	sProcessTableIsValid = true;
+	return true;
+}
+
+
+
+DWORD ProcessExist9x2000(char *aProcess, char *aProcessName)
+{
+	if (aProcessName) // Init this output variable in case of early return.
+		*aProcessName = '\0';
+
+	if (!ProcessTableUpdate())
+		return 0;
+
+	// Determine the PID if aProcess is a pure, non-negative integer (any negative number
+	// is more likely to be the name of a process [with a leading dash], rather than the PID).
+	DWORD specified_pid = IsPureNumeric(aProcess) ? ATOU(aProcess) : 0;
+	char *name;
+
+	// Search in snapshot order so that the first matching process is the one found, as before:
+	for (int i = 0; i < sProcessTableCount; ++i)
+	{
+		name = sProcessNames + sProcessTable[i].name_offset;
+		// Check for matching name even if aProcess is purely numeric (i.e. a number might
+		// also be a valid name?):
+		if (specified_pid && specified_pid == sProcessTable[i].pid
+			|| !stricmp(name, aProcess)) // lstrcmpi() is not used: 1) avoids breaking exisitng scripts; 2) provides consistent behavior across multiple locales; 3) performance.
+		{
+			if (aProcessName) // Caller wanted process name also.
+				strcpy(aProcessName, name);
+			return sProcessTable[i].pid;
+		}
+	}
 	return 0;  // Not found.
 }
 
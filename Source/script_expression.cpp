@@ -1780,6 +1780,8 @@ ResultType Line::ExpandArgs(VarSizeType aSpaceNeeded, Var *aArgVar[])
 	// the calling of functions in the script:
 	char *arg_deref[MAX_ARGS];
 	Var *arg_var[MAX_ARGS];
+	ResultType arg_must_deref[MAX_ARGS]; // Results of ArgMustBeDereferenced() from the first pass, so that the second pass doesn't have to call it again.
+	bool arg_must_deref_is_known;
 	int i;
 
 	// Make two passes through this line's arg list.  This is done because the performance of
@@ -1793,12 +1795,14 @@ ResultType Line::ExpandArgs(VarSizeType aSpaceNeeded, Var *aArgVar[])
 	size_t space_needed;
 	if (aSpaceNeeded == VARSIZE_ERROR)
 	{
-		space_needed = GetExpandedArgSize(arg_var);
+		space_needed = GetExpandedArgSize(arg_var, arg_must_deref);
 		if (space_needed == VARSIZE_ERROR)
 			return FAIL;  // It will have already displayed the error.
+		arg_must_deref_is_known = true;
 	}
 	else // Caller already determined it.
 	{
+		arg_must_deref_is_known = false; // Caller didn't provide these, so they will be determined in the second pass.
 		space_needed = aSpaceNeeded;
 		for (i = 0; i < mArgc; ++i) // Copying only the actual/used elements is probably faster than using memcpy to copy both entire arrays.
 			arg_var[i] = aArgVar[i]; // Init to values determined by caller, which helps performance if any of the args are dynamic variables.
@@ -1824,8 +1828,15 @@ ResultType Line::ExpandArgs(VarSizeType aSpaceNeeded, Var *aArgVar[])
 		// then the old size should be passed to FreeAndRestoreFunctionVars() so that it can restore it.
 		// However, given the rarity of deep recursion, this doesn't seem worth the extra code size and loss of
 		// performance.
-		size_t increments_needed = space_needed / DEREF_BUF_EXPAND_INCREMENT;
-		if (space_needed % DEREF_BUF_EXPAND_INCREMENT)  // Need one more if above division truncated it.
+		// Grow geometrically (up to LARGE_DEREF_BUF_SIZE) so that lines whose expanded args get a little
+		// longer each time they're executed, such as "Var = %Var%%Text%" in a loop, don't have to free and
+		// reallocate the buffer on every iteration.  Beyond LARGE_DEREF_BUF_SIZE, only the needed amount is
+		// allocated because such buffers are rare and freed when idle anyway (see SET_DEREF_TIMER):
+		size_t space_wanted = space_needed;
+		if (space_wanted < 2 * sDerefBufSize && 2 * sDerefBufSize <= LARGE_DEREF_BUF_SIZE)
+			space_wanted = 2 * sDerefBufSize;
+		size_t increments_needed = space_wanted / DEREF_BUF_EXPAND_INCREMENT;
+		if (space_wanted % DEREF_BUF_EXPAND_INCREMENT)  // Need one more if above division truncated it.
 			++increments_needed;
 		size_t new_buf_size = increments_needed * DEREF_BUF_EXPAND_INCREMENT;
 		if (sDerefBuf)
@@ -1906,6 +1917,11 @@ ResultType Line::ExpandArgs(VarSizeType aSpaceNeeded, Var *aArgVar[])
 				arg_deref[i] = ExpandExpression(i, result, our_buf_marker, our_deref_buf
 					, our_deref_buf_size, arg_deref, extra_size);
 				extra_size = 0; // See comment below.
+				// Any function called by the expression might have changed a variable used by a later arg,
+				// so the first pass's results from ArgMustBeDereferenced() can no longer be relied upon
+				// (e.g. a var that was blank, and thus had no space reserved for its contents, might now
+				// need to be copied into the buffer).  Have the remaining args re-evaluate it:
+				arg_must_deref_is_known = false;
 				// v1.0.46.01: The whole point of passing extra_size is to allow an expression to write
 				// a large string to the deref buffer without having to expand it (i.e. if there happens to
 				// be extra room in it that won't be used by ANY arg, including ones after THIS expression).
@@ -1958,7 +1974,10 @@ ResultType Line::ExpandArgs(VarSizeType aSpaceNeeded, Var *aArgVar[])
 
 			// Since above didn't "continue", the_only_var_of_this_arg==true, so this arg resolves to
 			// only a single, naked var.
-			switch(ArgMustBeDereferenced(the_only_var_of_this_arg, i, arg_var)) // Yes, it was called by GetExpandedArgSize() too, but a review shows it's difficult to avoid this without being worse than the disease (10/22/2006).
+			// Use the result from GetExpandedArgSize() when available, which avoids the cost of calling
+			// ArgMustBeDereferenced() a second time (it might have to query the clipboard or resolve output
+			// vars).  It isn't available for args that come after an expression (see above):
+			switch(arg_must_deref_is_known ? arg_must_deref[i] : ArgMustBeDereferenced(the_only_var_of_this_arg, i, arg_var))
 			{
 			case CONDITION_FALSE:
 				// This arg contains only a single dereference variable, and no
@@ -2083,8 +2102,10 @@ end:
 
 	
 
-VarSizeType Line::GetExpandedArgSize(Var *aArgVar[])
+VarSizeType Line::GetExpandedArgSize(Var *aArgVar[], ResultType aArgMustDeref[])
 // Returns the size, or VARSIZE_ERROR if there was a problem.
+// For each arg that resolves to a single variable, aArgMustDeref[] receives the result of ArgMustBeDereferenced()
+// for use by ExpandArgs(). Other elements are left uninitialized.
 // This function can return a size larger than what winds up actually being needed
 // (e.g. caused by ScriptGetCursor()), so our callers should be aware that that can happen.
 {
@@ -2146,7 +2167,7 @@ VarSizeType Line::GetExpandedArgSize(Var *aArgVar[])
 			// This is set for our caller so that it doesn't have to call ResolveVarOfArg() again, which
 			// would a performance hit if this variable is dynamically built and thus searched for at runtime:
 			aArgVar[i] = the_only_var_of_this_arg; // For now, this is done regardless of whether it must be dereferenced.
-			if (   !(result = ArgMustBeDereferenced(the_only_var_of_this_arg, i, aArgVar))   )
+			if (   !(aArgMustDeref[i] = result = ArgMustBeDereferenced(the_only_var_of_this_arg, i, aArgVar))   )
 				return VARSIZE_ERROR;
 			if (result == CONDITION_FALSE)
 				continue;
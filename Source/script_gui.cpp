@@ -70,6 +70,8 @@ ResultType Script::PerformGui(char *aCommand, char *aParam2, char *aParam3, char
 		case GUI_CMD_MINIMIZE:
 		case GUI_CMD_MAXIMIZE:
 		case GUI_CMD_RESTORE:
+		case GUI_CMD_BEGINUPDATE:
+		case GUI_CMD_ENDUPDATE:
 			goto return_the_result; // Nothing needs to be done since the window object doesn't exist.
 
 		// v1.0.43.09:
@@ -90,8 +92,10 @@ ResultType Script::PerformGui(char *aCommand, char *aParam2, char *aParam3, char
 			result = FAIL; // No error displayed since extremely rare.
 			goto return_the_result;
 		}
-		if (   !(g_gui[window_index]->mControl = (GuiControlType *)malloc(GUI_CONTROL_BLOCK_SIZE * sizeof(GuiControlType)))   )
+		if (   !(g_gui[window_index]->mControl = (GuiControlType *)malloc(GUI_CONTROL_BLOCK_SIZE * sizeof(GuiControlType)))
+			|| !(g_gui[window_index]->mControlByVar = (GuiVarIndexType *)malloc(GUI_CONTROL_BLOCK_SIZE * sizeof(GuiVarIndexType)))   )
 		{
+			free(g_gui[window_index]->mControl); // free() tolerates NULL.
 			delete g_gui[window_index];
 			g_gui[window_index] = NULL;
 			result = FAIL; // No error displayed since extremely rare.
@@ -191,18 +195,31 @@ ResultType Script::PerformGui(char *aCommand, char *aParam2, char *aParam3, char
 		goto return_the_result;
 
 	case GUI_CMD_MINIMIZE:
+		gui.EndUpdate(true); // Because the window's visibility might change (see EndUpdate()).
 		// If the window is hidden, it is unhidden as a side-effect (this happens even for SW_SHOWMINNOACTIVE).
 		ShowWindow(gui.mHwnd, SW_MINIMIZE);
 		goto return_the_result;
 
 	case GUI_CMD_MAXIMIZE:
+		gui.EndUpdate(true); // See above.
 		ShowWindow(gui.mHwnd, SW_MAXIMIZE); // If the window is hidden, it is unhidden as a side-effect.
 		goto return_the_result;
 
 	case GUI_CMD_RESTORE:
+		gui.EndUpdate(true); // See above.
 		ShowWindow(gui.mHwnd, SW_RESTORE); // If the window is hidden, it is unhidden as a side-effect.
 		goto return_the_result;
 
+	case GUI_CMD_BEGINUPDATE:
+		gui.BeginUpdate();
+		goto return_the_result;
+
+	case GUI_CMD_ENDUPDATE:
+		// ErrorLevel is set to the number of changes that were skipped because they wouldn't have changed
+		// anything.  This is mostly useful for tuning scripts that update many controls on a timer.
+		g_ErrorLevel->Assign(gui.EndUpdate(false));
+		goto return_the_result;
+
 	case GUI_CMD_FONT:
 		result = gui.SetCurrentFont(aParam2, aParam3);
 		goto return_the_result;
@@ -608,7 +625,8 @@ ResultType Line::GuiControl(char *aCommand, char *aControlID, char *aParam3)
 			// when done (or NULL if it failed to allocate the memory).
 			malloc_buf = (*aParam3 && (GetWindowLong(control.hwnd, GWL_STYLE) & ES_MULTILINE))
 				? TranslateLFtoCRLF(aParam3) : aParam3; // Automatic translation, as documented.
-			SetWindowText(control.hwnd,  malloc_buf ? malloc_buf : aParam3); // malloc_buf is checked again in case the mem alloc failed.
+			if (!gui.ControlTextIsUnchanged(control.hwnd, malloc_buf ? malloc_buf : aParam3)) // Also avoids resetting the caret and undo buffer needlessly.
+				SetWindowText(control.hwnd,  malloc_buf ? malloc_buf : aParam3); // malloc_buf is checked again in case the mem alloc failed.
 			if (malloc_buf && malloc_buf != aParam3)
 				free(malloc_buf);
 			goto return_the_result;
@@ -817,6 +835,8 @@ ResultType Line::GuiControl(char *aCommand, char *aControlID, char *aParam3)
 		// 1) A control that uses the standard SetWindowText() method such as GUI_CONTROL_TEXT,
 		//    GUI_CONTROL_GROUPBOX, or GUI_CONTROL_BUTTON.
 		// 2) A radio or checkbox whose caption is being changed instead of its checked state.
+		if (gui.ControlTextIsUnchanged(control.hwnd, aParam3)) // Within a "Gui BeginUpdate", skip the change and its redraw.
+			goto return_the_result;
 		SetWindowText(control.hwnd, aParam3); // Seems more reliable to set text before doing the redraw, plus it saves code size.
 		if (do_redraw_unconditionally)
 			break;
@@ -964,6 +984,7 @@ ResultType Line::GuiControl(char *aCommand, char *aControlID, char *aParam3)
 				goto return_the_result; // v1.0.48.04: Concerning the line above, see comments in GUICONTROL_CMD_DISABLE.
 		}
 		// Since above didn't return, act upon the show/hide:
+		gui.ControlThaw(control); // See ControlThaw() for why this must be done first.
 		ShowWindow(control.hwnd, guicontrol_cmd == GUICONTROL_CMD_SHOW ? SW_SHOWNOACTIVATE : SW_HIDE);
 		if (control.type == GUI_CONTROL_TAB) // This control is a tab control.
 			// Update the control so that its current tab's controls will all be shown or hidden (now
@@ -1155,7 +1176,7 @@ ResultType Line::GuiControl(char *aCommand, char *aControlID, char *aParam3)
 
 	// If the above didn't return, it wants this check:
 	if (   do_redraw_unconditionally
-		|| (tab_control = gui.FindTabControl(control.tab_control_index)) && IsWindowVisible(control.hwnd)   )
+		|| (tab_control = gui.FindTabControl(control.tab_control_index)) && gui.ControlIsVisible(control)   )
 	{
 		GetWindowRect(control.hwnd, &rect); // Limit it to only that part of the client area that is receiving the rect.
 		MapWindowPoints(NULL, gui.mHwnd, (LPPOINT)&rect, 2); // Convert rect to client coordinates (not the same as GetClientRect()).
@@ -1325,7 +1346,7 @@ ResultType Line::GuiControlGet(char *aCommand, char *aControlID, char *aParam3)
 		// this "visible" sub-cmd is kept separate from some figure command such as "GuiControlGet, Out, Style":
 		// 1) The style method is cumbersome to script with since it requires bitwise operates afterward.
 		// 2) IsVisible() uses a different standard of detection than simply checking WS_VISIBLE.
-		result = output_var.Assign(IsWindowVisible(control.hwnd) ? "1" : "0");
+		result = output_var.Assign(gui.ControlIsVisible(control) ? "1" : "0"); // Not IsWindowVisible() in case the control is frozen by an update.
 		goto return_the_result;
 
 	case GUICONTROLGET_CMD_HWND: // v1.0.46.16: Although it overlaps with HwndOutputVar, Majkinetor wanted this to help with encapsulation/modularization.
@@ -1349,6 +1370,7 @@ FontType *GuiType::sFont = NULL; // An array of structs, allocated upon first us
 int GuiType::sFontCount = 0;
 int GuiType::sGuiCount = 0;
 HWND GuiType::sTreeWithEditInProgress = NULL;
+int GuiType::sUpdateCount = 0;
 
 
 
@@ -1363,6 +1385,9 @@ ResultType GuiType::Destroy(GuiIndexType aWindowIndex)
 	GuiType &gui = *g_gui[aWindowIndex];  // For performance and convenience.
 	GuiIndexType u, gui_count;
 
+	if (gui.mUpdateDepth) // There's no need to end the update properly since the controls are about to be destroyed.
+		--sUpdateCount;
+
 	if (gui.mHwnd)
 	{
 		// First destroy any windows owned by this window, since they will be auto-destroyed
@@ -1440,13 +1465,23 @@ ResultType GuiType::Destroy(GuiIndexType aWindowIndex)
 			//else do nothing, since it isn't the right type to have a valid union_hbitmap member.
 		}
 		else if (control.type == GUI_CONTROL_LISTVIEW) // It was ensured at an earlier stage that union_lv_attrib != NULL.
+		{
+			if (control.union_lv_attrib->virt)
+			{
+				LV_VirtualDeleteAll(*control.union_lv_attrib->virt);
+				free(control.union_lv_attrib->virt);
+			}
 			free(control.union_lv_attrib);
+		}
+		else if (control.type == GUI_CONTROL_TREEVIEW)
+			TV_FreeAllPending(control.hwnd);
 	}
 	// Not necessary since the object itself is about to be destroyed:
 	//gui.mHwnd = NULL;
 	//gui.mControlCount = 0; // All child windows (controls) are automatically destroyed with parent.
 	HICON icon_eligible_for_destruction = gui.mIconEligibleForDestruction;
 	free(gui.mControl); // Free the control array, which was previously malloc'd.
+	free(gui.mControlByVar);
 	delete g_gui[aWindowIndex]; // After this, the var "gui" is invalid so should not be referenced, i.e. the next line.
 	g_gui[aWindowIndex] = NULL;
 	--sGuiCount; // This count is maintained to help performance in the main event loop and other places.
@@ -1660,6 +1695,13 @@ ResultType GuiType::AddControl(GuiControls aControlType, char *aOptions, char *a
 			, (mControlCapacity + GUI_CONTROL_BLOCK_SIZE) * sizeof(GuiControlType)))   )
 			return g_script.ScriptError(TOO_MANY_CONTROLS); // A non-specific msg since this error is so rare.
 		mControl = realloc_temp;
+		// Grow the variable index to match so that IndexControlVar() never needs to allocate anything.
+		// mControlCapacity is updated only after both have succeeded because it's the capacity of both:
+		GuiVarIndexType *realloc_index;
+		if (   !(realloc_index = (GuiVarIndexType *)realloc(mControlByVar
+			, (mControlCapacity + GUI_CONTROL_BLOCK_SIZE) * sizeof(GuiVarIndexType)))   )
+			return g_script.ScriptError(TOO_MANY_CONTROLS);
+		mControlByVar = realloc_index;
 		mControlCapacity += GUI_CONTROL_BLOCK_SIZE;
 	}
 
@@ -2872,9 +2914,19 @@ ResultType GuiType::AddControl(GuiControls aControlType, char *aOptions, char *a
 				control.hwnd = NULL;
 				break;
 			}
+			ZeroMemory(control.union_lv_attrib, sizeof(lv_attrib_type));
+			if (style & LVS_OWNERDATA) // The "Virtual" option: the rows will be stored by us rather than the control.
+			{
+				if (   !(control.union_lv_attrib->virt = (lv_virtual_type *)calloc(1, sizeof(lv_virtual_type)))   )
+				{
+					free(control.union_lv_attrib); // See comments above.
+					DestroyWindow(control.hwnd);
+					control.hwnd = NULL;
+					break;
+				}
+			}
 			// Otherwise:
 			mCurrentListView = &control;
-			ZeroMemory(control.union_lv_attrib, sizeof(lv_attrib_type));
 			control.union_lv_attrib->sorted_by_col = -1; // Indicate that there is currently no sort order.
 			control.union_lv_attrib->no_auto_sort = opt.listview_no_auto_sort;
 
@@ -3441,6 +3493,8 @@ ResultType GuiType::AddControl(GuiControls aControlType, char *aOptions, char *a
 		return g_script.ScriptError("Can't create control." ERR_ABORT);
 	// Otherwise the above control creation succeeded.
 	++mControlCount;
+	if (control.output_var) // Done only now that it's been added, so that the index never refers to a control that failed to be created.
+		IndexControlVar(mControlCount - 1, NULL);
 	mControlWidthWasSetByContents = control_width_was_set_by_contents; // Set for use by next control, if any.
 	if (opt.hwnd_output_var) // v1.0.46.01.
 		opt.hwnd_output_var->AssignHWND(control.hwnd);
@@ -3480,7 +3534,10 @@ ResultType GuiType::AddControl(GuiControls aControlType, char *aOptions, char *a
 		GUI_SETFONT
 
 	if (opt.redraw == CONDITION_FALSE)
+	{
 		SendMessage(control.hwnd, WM_SETREDRAW, FALSE, 0); // Disable redrawing for this control to allow contents to be added to it more quickly.
+		control.redraw_off = GUI_REDRAW_OFF_BY_SCRIPT;
+	}
 		// It's not necessary to do the following because by definition the control has just been created
 		// and thus redraw can't have been off for it previously:
 		//if (opt.redraw == CONDITION_TRUE) // Since redrawing is being turned back on, invalidate the control so that it updates itself.
@@ -4190,7 +4247,10 @@ ResultType GuiType::ControlParseOptions(char *aOptions, GuiControlOptionsType &a
 			if (next_option[6] && !ATOI(next_option + 6)) // If it's Hidden0, invert the mode to become "show".
 				adding = !adding;
 			if (aControl.hwnd) // More correct to call ShowWindow() and let it set the style.  Do not set the style explicitly in this case since that might break it.
+			{
+				ControlThaw(aControl); // See ControlThaw() for why this must be done first.
 				ShowWindow(aControl.hwnd, adding ? SW_HIDE : SW_SHOWNOACTIVATE);
+			}
 			else
 				if (adding) aOpt.style_remove |= WS_VISIBLE; else aOpt.style_add |= WS_VISIBLE;
 		}
@@ -4319,6 +4379,11 @@ ResultType GuiType::ControlParseOptions(char *aOptions, GuiControlOptionsType &a
 			else // Header is still clickable (unless above is *also* specified), but has no automatic sorting.
 				aOpt.listview_no_auto_sort = adding;
 		}
+		else if (aControl.type == GUI_CONTROL_LISTVIEW && !stricmp(next_option, "Virtual"))
+		{
+			// Like NoSortHdr, this can't be changed after the control is created, so it's ignored by GuiControl:
+			if (adding && !aControl.hwnd) aOpt.style_add |= LVS_OWNERDATA;
+		}
 		else if (aControl.type == GUI_CONTROL_LISTVIEW && !stricmp(next_option, "Grid"))
 			if (adding) aOpt.listview_style |= LVS_EX_GRIDLINES; else aOpt.listview_style &= ~LVS_EX_GRIDLINES;
 		else if (!strnicmp(next_option, "Count", 5)) // Script should only provide the option for ListViews.
@@ -4981,7 +5046,14 @@ ResultType GuiType::ControlParseOptions(char *aOptions, GuiControlOptionsType &a
 					aControl.jump_to_label = NULL;
 					break;
 				case 'V':
-					aControl.output_var = NULL;
+					if (aControl.hwnd && aControl.output_var) // An existing control (new ones are indexed by AddControl()).
+					{
+						Var *old_var = aControl.output_var;
+						aControl.output_var = NULL;
+						IndexControlVar(aControlIndex, old_var);
+					}
+					else
+						aControl.output_var = NULL;
 					break;
 				}
 				*option_end = orig_char; // Undo the temporary termination because the caller needs aOptions to be unaltered.
@@ -5074,13 +5146,18 @@ ResultType GuiType::ControlParseOptions(char *aOptions, GuiControlOptionsType &a
 				// changes to it, etc.)  Note that if this is the first control being added, mControlCount
 				// is now zero because this control has not yet actually been added.  That is why
 				// "u < mControlCount" is used:
-				GuiIndexType u;
-				for (u = 0; u < mControlCount; ++u)
-					if (mControl[u].output_var == candidate_var)
-						return aControl.hwnd ? g_ErrorLevel->Assign(ERRORLEVEL_ERROR)
-							: g_script.ScriptError("The same variable cannot be used for more than one control." // It used to say "one control per window" but that seems more confusing than it's worth.
-								ERR_ABORT, next_option - 1);
-				aControl.output_var = candidate_var;
+				if (FindControlByVar(candidate_var) != NO_CONTROL_INDEX)
+					return aControl.hwnd ? g_ErrorLevel->Assign(ERRORLEVEL_ERROR)
+						: g_script.ScriptError("The same variable cannot be used for more than one control." // It used to say "one control per window" but that seems more confusing than it's worth.
+							ERR_ABORT, next_option - 1);
+				if (aControl.hwnd) // An existing control (new ones are indexed by AddControl()).
+				{
+					Var *old_var = aControl.output_var;
+					aControl.output_var = candidate_var;
+					IndexControlVar(aControlIndex, old_var);
+				}
+				else
+					aControl.output_var = candidate_var;
 				break;
 
 			case 'E':  // Extended style
@@ -5546,6 +5623,9 @@ ResultType GuiType::ControlParseOptions(char *aOptions, GuiControlOptionsType &a
 		if (aOpt.redraw)
 		{
 			SendMessage(aControl.hwnd, WM_SETREDRAW, aOpt.redraw == CONDITION_TRUE, 0);
+			// So that functions which disable redrawing temporarily know not to turn it back on.  This also
+			// overrides any freezing by "Gui BeginUpdate", since the script has now explicitly chosen:
+			aControl.redraw_off = (aOpt.redraw == CONDITION_FALSE) ? GUI_REDRAW_OFF_BY_SCRIPT : 0;
 			if (aOpt.redraw == CONDITION_TRUE // Since redrawing is being turned back on, invalidate the control so that it updates itself.
 				&& aControl.type != GUI_CONTROL_TREEVIEW) // This type is documented not to need it; others like ListView are not, so might need it on some OSes or under some conditions.
 				do_invalidate_rect = true;
@@ -5742,6 +5822,7 @@ ResultType GuiType::Show(char *aOptions, char *aText)
 {
 	if (!mHwnd)
 		return OK;  // Make this a harmless attempt.
+	EndUpdate(true); // So that the window never appears with unpainted controls (see EndUpdate()).
 
 	// In the future, it seems best to rely on mShowIsInProgress to prevent the Window Proc from ever
 	// doing a MsgSleep() to launch a script subroutine.  This is because if anything we do in this
@@ -6251,6 +6332,7 @@ ResultType GuiType::Clear() // Not implemented yet.
 
 ResultType GuiType::Cancel()
 {
+	EndUpdate(true); // The batch of changes is presumably complete (see EndUpdate()).
 	if (mHwnd)
 		ShowWindow(mHwnd, SW_HIDE);
 	return OK;
@@ -6258,6 +6340,111 @@ ResultType GuiType::Cancel()
 
 
 
+void GuiType::BeginUpdate()
+// Starts a batch of changes to this window's controls ("Gui BeginUpdate").  The controls aren't redrawn
+// until the matching EndUpdate, so a script that updates many controls at once causes a single repaint
+// rather than one per control (which flickers and uses a lot of CPU).  Calls may be nested.
+// Redrawing is turned off for each control rather than for the window itself because WM_SETREDRAW works
+// by clearing WS_VISIBLE (in DefWindowProc), which would make the whole window look hidden to WinExist,
+// #IfWinActive and the like, and would undo any WinHide done during the update.  Tab controls and status
+// bars are excluded because their visibility is checked via WS_VISIBLE in many places; the same is true
+// of hidden controls, since turning redraw back on would show them.  A frozen control still looks hidden
+// to commands outside this GuiType (e.g. ControlGet Visible) until the update ends.
+{
+	if (mUpdateDepth++)
+		return; // An update is already in progress.
+	++sUpdateCount;
+	mUpdateThread = g;
+	mUpdatesSkipped = 0;
+	for (GuiIndexType u = 0; u < mControlCount; ++u)
+	{
+		GuiControlType &control = mControl[u];
+		if (control.redraw_off // The script has already turned it off, so leave it that way.
+			|| control.type == GUI_CONTROL_TAB || control.type == GUI_CONTROL_STATUSBAR
+			|| !(GetWindowLong(control.hwnd, GWL_STYLE) & WS_VISIBLE))
+			continue;
+		SendMessage(control.hwnd, WM_SETREDRAW, FALSE, 0);
+		control.redraw_off = GUI_REDRAW_OFF_BY_UPDATE;
+	}
+}
+
+
+
+void GuiType::ControlThaw(GuiControlType &aControl)
+// Turns redrawing back on for aControl if an update turned it off.  This must be done prior to showing or
+// hiding the control, since WM_SETREDRAW's toggling of WS_VISIBLE would conflict with that.
+{
+	if (aControl.redraw_off & GUI_REDRAW_OFF_BY_UPDATE)
+	{
+		SendMessage(aControl.hwnd, WM_SETREDRAW, TRUE, 0);
+		aControl.redraw_off = 0;
+		InvalidateRect(aControl.hwnd, NULL, TRUE); // MSDN: WM_SETREDRAW doesn't by itself repaint the control.
+	}
+}
+
+
+
+int GuiType::EndUpdate(bool aEndAll)
+// Ends the update started by BeginUpdate (or all of them if aEndAll is true) and redraws everything
+// once.  aEndAll is used prior to showing the window, so that it never appears with unpainted controls,
+// and when the window is hidden or minimized, etc. since the batch of changes is then presumably complete.
+// Returns the number of changes that were skipped during the update because they wouldn't have changed
+// anything.
+{
+	if (!mUpdateDepth || --mUpdateDepth && !aEndAll)
+		return mUpdatesSkipped; // No update in progress or an outer one is still in effect.
+	mUpdateDepth = 0;
+	--sUpdateCount;
+	mUpdateThread = NULL;
+	bool redraw_needed = false;
+	for (GuiIndexType u = 0; u < mControlCount; ++u)
+	{
+		if (mControl[u].redraw_off & GUI_REDRAW_OFF_BY_UPDATE)
+		{
+			ControlThaw(mControl[u]);
+			redraw_needed = true;
+		}
+	}
+	if (redraw_needed && IsWindowVisible(mHwnd)) // MSDN: WM_SETREDRAW doesn't by itself repaint anything.
+		RedrawWindow(mHwnd, NULL, NULL, RDW_ERASE|RDW_FRAME|RDW_INVALIDATE|RDW_ALLCHILDREN);
+	return mUpdatesSkipped;
+}
+
+
+
+void GuiType::EndThreadUpdates()
+// Called when a thread finishes (even due to an error) to end any update it began but didn't end, so that
+// a missing "Gui EndUpdate" can't leave a window's controls frozen indefinitely.
+{
+	if (!sUpdateCount)
+		return;
+	for (int i = 0; i < MAX_GUI_WINDOWS; ++i)
+		if (g_gui[i] && g_gui[i]->mUpdateDepth && g_gui[i]->mUpdateThread == g)
+			g_gui[i]->EndUpdate(true);
+}
+
+
+
+bool GuiType::ControlTextIsUnchanged(HWND aControlHwnd, char *aNewText)
+// Returns true if an update is in progress (see BeginUpdate) and aControlHwnd already has aNewText,
+// in which case the caller should skip setting it.  This is only done during an update because it
+// costs a WM_GETTEXT, which is worthwhile only for scripts that tend to set the same text repeatedly.
+{
+	if (!mUpdateDepth)
+		return false;
+	char buf[1024];
+	int length = GetWindowTextLength(aControlHwnd);
+	if (length >= sizeof(buf) || (size_t)length != strlen(aNewText)) // Comparing long text isn't worth it, nor is a buffer for it.
+		return false;
+	GetWindowText(aControlHwnd, buf, sizeof(buf));
+	if (strcmp(buf, aNewText))
+		return false;
+	++mUpdatesSkipped;
+	return true;
+}
+
+
+
 ResultType GuiType::Close()
 // If there is a GuiClose label defined in for this event, launch it as a new thread.
 // In this case, don't close or hide the window.  It's up to the subroutine to do that
@@ -6374,7 +6561,10 @@ ResultType GuiType::Submit(bool aHideIt)
 	} // for()
 
 	if (aHideIt)
+	{
+		EndUpdate(true); // The batch of changes is presumably complete (see EndUpdate()).
 		ShowWindow(mHwnd, SW_HIDE);
+	}
 	return OK;
 }
 
@@ -6769,9 +6959,8 @@ GuiIndexType GuiType::FindControl(char *aControlID)
 	{
 		// No need to do "var = var->ResolveAlias()" because the line above never finds locals, only globals.
 		// Similarly, there's no need to do confirm that var->IsLocal()==false.
-		for (u = 0; u < mControlCount; ++u)
-			if (mControl[u].output_var == var)
-				return u;  // Match found.
+		if ((u = FindControlByVar(var)) != NO_CONTROL_INDEX)
+			return u;  // Match found.
 	}
 	if (g->CurrentFunc // v1.0.46.15: Since above failed to match: if we're in a function (which is checked for performance reasons), search for a static or ByRef-that-points-to-a-global-or-static because both should be supported.
 		&& (var = g_script.FindVar(aControlID, 0, NULL, ALWAYS_USE_LOCAL)))
@@ -6779,24 +6968,89 @@ GuiIndexType GuiType::FindControl(char *aControlID)
 		// No need to do "var = var->ResolveAlias()" because the line above never finds locals, only globals.
 		// Similarly, there's no need to do confirm that var->IsLocal()==false.
 		var = var->ResolveAlias(); // Update it to its target if it's an alias because that's how control-var's are stored (i.e. pre-resolved, never aliases).
-		if (!var->IsNonStaticLocal()) // To be a valid control-var, it must be global, static, or a ByRef that points to a global or static.
-			for (u = 0; u < mControlCount; ++u)
-				if (mControl[u].output_var == var)
-					return u;  // Match found.
+		if (!var->IsNonStaticLocal() // To be a valid control-var, it must be global, static, or a ByRef that points to a global or static.
+			&& (u = FindControlByVar(var)) != NO_CONTROL_INDEX)
+			return u;  // Match found.
 	}
 	// Otherwise: No match found, so fall back to standard control class and/or text finding method.
 	HWND control_hwnd = ControlExist(mHwnd, aControlID);
 	if (!control_hwnd)
 		return -1; // No match found.
-	for (u = 0; u < mControlCount; ++u)
-		if (mControl[u].hwnd == control_hwnd)
-			return u;  // Match found.
+	// The HWND is checked because ControlExist() might have found a child of one of our controls (such
+	// as a ComboBox's Edit), whose ID has nothing to do with our indices:
+	u = GUI_HWND_TO_INDEX(control_hwnd); // Much faster than searching mControl for control_hwnd.
+	if (u < mControlCount && mControl[u].hwnd == control_hwnd)
+		return u;  // Match found.
 	// Otherwise: No match found.  At this stage, should be impossible if design is correct.
 	return -1;
 }
 
 
 
+GuiIndexType GuiType::FindControlByVar(Var *aVar)
+// Returns the index of the control whose output variable is aVar, or NO_CONTROL_INDEX if none.
+// This uses mControlByVar rather than searching mControl because windows with thousands of controls
+// would otherwise spend most of the time of each GuiControl/GuiControlGet in that search.
+{
+	int left, right, mid;
+	for (left = 0, right = (int)mControlByVarCount - 1; left <= right;)
+	{
+		mid = (left + right) / 2;
+		if (aVar == mControlByVar[mid].var)
+			return mControlByVar[mid].control_index;
+		if (aVar < mControlByVar[mid].var)
+			right = mid - 1;
+		else
+			left = mid + 1;
+	}
+	return NO_CONTROL_INDEX;
+}
+
+
+
+void GuiType::IndexControlVar(GuiIndexType aControlIndex, Var *aOldVar)
+// Updates mControlByVar after the output variable of the control at aControlIndex has changed from
+// aOldVar (NULL if it had none) to its current one (which may also be NULL).
+{
+	int left, right, mid;
+	if (aOldVar)
+	{
+		for (left = 0, right = (int)mControlByVarCount - 1; left <= right;)
+		{
+			mid = (left + right) / 2;
+			if (aOldVar == mControlByVar[mid].var)
+			{
+				memmove(mControlByVar + mid, mControlByVar + mid + 1, (mControlByVarCount - mid - 1) * sizeof(GuiVarIndexType));
+				--mControlByVarCount;
+				break;
+			}
+			if (aOldVar < mControlByVar[mid].var)
+				right = mid - 1;
+			else
+				left = mid + 1;
+		}
+	}
+	Var *new_var = mControl[aControlIndex].output_var;
+	if (!new_var)
+		return;
+	// Find the insertion point.  Callers have ensured that new_var isn't already present.
+	for (left = 0, right = (int)mControlByVarCount - 1; left <= right;)
+	{
+		mid = (left + right) / 2;
+		if (new_var < mControlByVar[mid].var)
+			right = mid - 1;
+		else
+			left = mid + 1;
+	}
+	// mControlByVar has the same capacity as mControl, so there's always room.
+	memmove(mControlByVar + left + 1, mControlByVar + left, (mControlByVarCount - left) * sizeof(GuiVarIndexType));
+	mControlByVar[left].var = new_var;
+	mControlByVar[left].control_index = aControlIndex;
+	++mControlByVarCount;
+}
+
+
+
 int GuiType::FindGroup(GuiIndexType aControlIndex, GuiIndexType &aGroupStart, GuiIndexType &aGroupEnd)
 // Caller must provide a valid aControlIndex for an existing control.
 // Returns the number of radio buttons inside the group. In addition, it provides start and end
@@ -7092,7 +7346,7 @@ LRESULT CALLBACK GuiWindowProc(HWND hWnd, UINT iMsg, WPARAM wParam, LPARAM lPara
 	// CalledByIsDialogMessageOrDispatch for any threads beneath it.  Although this may technically be
 	// unnecessary, it adds maintainability.
 	LRESULT msg_reply;
-	if (g_MsgMonitorCount // Count is checked here to avoid function-call overhead.
+	if (MSG_MAY_BE_MONITORED(iMsg) // Filter is checked here to avoid function-call overhead.
 		&& (!g->CalledByIsDialogMessageOrDispatch || g->CalledByIsDialogMessageOrDispatchMsg != iMsg) // v1.0.44.11: If called by IsDialog or Dispatch but they changed the message number, check if the script is monitoring that new number.
 		&& MsgMonitor(hWnd, iMsg, wParam, lParam, NULL, msg_reply))
 		return msg_reply; // MsgMonitor has returned "true", indicating that this message should be omitted from further processing.
@@ -7261,8 +7515,44 @@ LRESULT CALLBACK GuiWindowProc(HWND hWnd, UINT iMsg, WPARAM wParam, LPARAM lPara
 			case LVN_DELETEITEM: // Might be received for each individual (non-DeleteAll) deletion).
 			case LVN_GETINFOTIPW: // v1.0.44: Received even without LVS_EX_INFOTIP?. In any case, there's currently no point
 			case LVN_GETINFOTIPA: // in notifying the script because it would have no means of changing the tip (by altering the struct), except perhaps OnMessage.
+			case LVN_ODCACHEHINT: // Virtual ListView: The text is already in memory, so there's nothing to prepare.
 				return 0; // Return immediately to avoid calling Event() and DefDlgProc(). A return value of 0 is suitable for all of the above.
 
+			case LVN_GETDISPINFOA: // Virtual ListView: Provide the text of a field that's about to be displayed.
+			case LVN_GETDISPINFOW: // Handled in case it's received even for non-Unicode apps (as with LVN_BEGINLABELEDITW).
+			{
+				LVITEM &item = ((NMLVDISPINFO *)lParam)->item;
+				if (control.union_lv_attrib->virt && (item.mask & LVIF_TEXT) && item.cchTextMax > 0)
+				{
+					char *text = GuiType::LV_VirtualGetText(*control.union_lv_attrib->virt, item.iItem, item.iSubItem);
+					if (nmhdr.code == LVN_GETDISPINFOW)
+					{
+						if (!ToWideChar(text, (LPWSTR)item.pszText, item.cchTextMax)) // Insufficient buffer, so show nothing rather than garbage.
+							*(LPWSTR)item.pszText = '\0';
+					}
+					else
+						strlcpy(item.pszText, text, item.cchTextMax);
+				}
+				return 0;
+			}
+
+			case LVN_ODFINDITEMA: // Virtual ListView: The user typed the beginning of an item's text (incremental search).
+			{
+				lv_virtual_type *virt = control.union_lv_attrib->virt;
+				NMLVFINDITEM &find = *(NMLVFINDITEM *)lParam;
+				if (!virt || !(find.lvfi.flags & (LVFI_STRING | LVFI_PARTIAL)) || !find.lvfi.psz || !virt->row_count)
+					return -1; // Not found.
+				size_t length = strlen(find.lvfi.psz);
+				int start = (find.iStart >= 0 && find.iStart < virt->row_count) ? find.iStart : 0;
+				for (int i = start, j = 0; j < virt->row_count; ++j, i = (i + 1 < virt->row_count) ? i + 1 : 0) // Wrap around to the top like the control does.
+				{
+					char *text = GuiType::LV_VirtualGetText(*virt, i, 0);
+					if ((find.lvfi.flags & LVFI_PARTIAL) ? !strnicmp(text, find.lvfi.psz, length) : !stricmp(text, find.lvfi.psz))
+						return i;
+				}
+				return -1;
+			}
+
 			case 0xFFFFFF4F: // Couldn't find these in commctrl.h anywhere. They seem to occur when control is first created and once for each row in the first set of added rows.
 			case 0xFFFFFF5F:
 			case 0xFFFFFF5D: // Probably something to do with incremental search since it seems to happen only when items are present and the user types a visible-character key.
@@ -7456,16 +7746,44 @@ LRESULT CALLBACK GuiWindowProc(HWND hWnd, UINT iMsg, WPARAM wParam, LPARAM lPara
 			{
 			case NM_SETCURSOR:  // Received very often, every time the mouse moves while over the control.
 			case NM_CUSTOMDRAW: // Return CDRF_DODEFAULT (0). Occurs for every redraw, such as mouse cursor sliding over control or window activation.
-			case TVN_DELETEITEMW:
+				return 0; // Return immediately to avoid calling Event() and DefDlgProc().
+
+			case TVN_DELETEITEMW: // The NMTREEVIEWA and NMTREEVIEWW structs are identical apart from the type of pszText, which isn't used here.
 			case TVN_DELETEITEMA:
+				// Free the descendants of any item added lazily by TV_AddMany() that was never expanded:
+				free(TV_TakePending(control.hwnd, ((LPNMTREEVIEW)lParam)->itemOld.hItem, ((LPNMTREEVIEW)lParam)->itemOld.lParam)); // free() does nothing when given NULL.
+				return 0;
+
+			case TVN_ITEMEXPANDINGW: // See TVN_DELETEITEMW above.
+			case TVN_ITEMEXPANDINGA:
+			{
+				// If this item was added lazily by TV_AddMany(), add its children now that they're about to be shown:
+				TVITEM &item = ((LPNMTREEVIEW)lParam)->itemNew;
+				tv_pending_type *pending;
+				if ((((LPNMTREEVIEW)lParam)->action & TVE_EXPAND) && (pending = TV_TakePending(control.hwnd, item.hItem, item.lParam))) // Assign.
+				{
+					TVITEM tvi;
+					tvi.hItem = item.hItem;
+					tvi.mask = TVIF_PARAM;
+					tvi.lParam = 0; // Detach it from the item, since TV_TakePending() has already removed it from the table.
+					TreeView_SetItem(control.hwnd, &tvi);
+					if (!TV_AddLines(control.hwnd, item.hItem, pending->text, pending->base_depth, true))
+					{
+						tvi.mask = TVIF_CHILDREN;
+						tvi.cChildren = 0; // Remove the expansion button since there turned out to be no children.
+						TreeView_SetItem(control.hwnd, &tvi);
+					}
+					free(pending);
+				}
+				return 0; // Allow the expansion.
+			}
+
 			// TVN_SELCHANGING, TVN_ITEMEXPANDING, and TVN_SINGLEEXPAND are not reported to the script as events
 			// because there is currently no support for vetoing the selection-change or expansion; plus these
 			// notifications each have an "-ED" counterpart notification that is reported to the script (even
 			// TVN_SINGLEEXPAND is followed by a TVN_ITEMEXPANDED notification).
 			case TVN_SELCHANGINGW:   // Received even for non-Unicode apps, at least on XP.
 			case TVN_SELCHANGINGA:
-			case TVN_ITEMEXPANDINGW: // Received even for non-Unicode apps, at least on XP.
-			case TVN_ITEMEXPANDINGA:
 			case TVN_SINGLEEXPAND: // Note that TVNRET_DEFAULT==0. This is received only when style contains TVS_SINGLEEXPAND.
 			case TVN_GETINFOTIPA: // Received when TVS_INFOTIP is present. However, there's currently no point
 			case TVN_GETINFOTIPW: // in notifying the script because it would have no means of changing the tip (by altering the struct), except perhaps OnMessage.
@@ -8674,7 +8992,9 @@ void GuiType::ControlSetListViewOptions(GuiControlType &aControl, GuiControlOpti
 {
 	if (aOpt.limit)
 	{
-		if (ListView_GetItemCount(aControl.hwnd) > 0)
+		if (aControl.union_lv_attrib->virt) // LVM_SETITEMCOUNT would create actual rows, so just reserve memory for them instead.
+			LV_VirtualReserve(*aControl.union_lv_attrib->virt, aOpt.limit, 0);
+		else if (ListView_GetItemCount(aControl.hwnd) > 0)
 			SendMessage(aControl.hwnd, LVM_SETITEMCOUNT, aOpt.limit, 0); // Last parameter should be 0 for LVS_OWNERDATA (verified if you look at the definition of ListView_SetItemCount macro).
 		else
 			// When the control has no rows, work around the fact that LVM_SETITEMCOUNT delivers less than 20%
@@ -8874,6 +9194,7 @@ void GuiType::ControlUpdateCurrentTab(GuiControlType &aTabControl, bool aFocusFi
 		// Don't use IsWindowVisible() because if the parent window is hidden, I think that will
 		// always say that the controls are hidden too.  In any case, IsWindowVisible() does not
 		// work correctly for this when the window is first shown:
+		ControlThaw(control); // Otherwise, the WS_VISIBLE below would be wrong for a control frozen by "Gui BeginUpdate".
 		style = GetWindowLong(control.hwnd, GWL_STYLE);
 		has_visible_style =  style & WS_VISIBLE;
 		has_enabled_style = !(style & WS_DISABLED);
@@ -9355,6 +9676,126 @@ int CALLBACK LV_Int32Sort(LPARAM lParam1, LPARAM lParam2, LPARAM lParamSort)
 
 
 
+struct LV_SortKeyType
+{
+	union
+	{
+		double number;      // For LV_COL_FLOAT.
+		size_t text_offset; // For LV_COL_TEXT: the offset of this row's text in sKeySortText.
+	};
+	int row; // The row's index prior to the sort.
+};
+
+// The following are used by LV_KeySortCompare() because qsort() provides no way to pass it a context.
+// This is safe because sorting never yields to other threads.
+static char *sKeySortText;
+static lv_col_type sKeySortCol;
+static int sKeySortDirection; // 1 for ascending, -1 for descending.
+
+int LV_KeySortCompare(const void *a1, const void *a2)
+{
+	LV_SortKeyType &key1 = *(LV_SortKeyType *)a1, &key2 = *(LV_SortKeyType *)a2;
+	int result;
+	if (sKeySortCol.type == LV_COL_TEXT)
+	{
+		if (sKeySortCol.case_sensitive == SCS_INSENSITIVE_LOGICAL) // The text was retrieved as Unicode in this case.
+			result = g_StrCmpLogicalW((LPCWSTR)(sKeySortText + key1.text_offset), (LPCWSTR)(sKeySortText + key2.text_offset));
+		else
+			result = strcmp2(sKeySortText + key1.text_offset, sKeySortText + key2.text_offset, sKeySortCol.case_sensitive);
+	}
+	else
+		result = (key1.number > key2.number) ? 1 : (key1.number == key2.number ? 0 : -1);
+	if (result)
+		return result * sKeySortDirection;
+	// Otherwise, break the tie by the original order, which makes this a stable sort.
+	return key1.row - key2.row;
+}
+
+
+
+bool LV_KeySort(HWND aHwnd, int aColumnIndex, LV_SortType &lvs, int aItemCount)
+// Sorts a text or float column by retrieving each row's field only once (rather than twice per comparison
+// as LV_GeneralSort() does), sorting those keys in our own memory, and then giving each row its new position
+// as its lParam so that the control can be put into that order by the high performance LV_Int32Sort.
+// This avoids the O(n log n) cross-control messages of LV_GeneralSort(), which made large ListViews
+// take several seconds to sort.  Caller must have set lvs.col, lvs.sort_ascending and lvs.lvi.cchTextMax
+// (halved for SCS_INSENSITIVE_LOGICAL).  Returns false without having changed anything if there isn't
+// enough memory, in which case the caller should use LV_GeneralSort() instead.
+{
+	LV_SortKeyType *key = (LV_SortKeyType *)malloc(aItemCount * sizeof(LV_SortKeyType));
+	if (!key)
+		return false;
+	bool is_text = (lvs.col.type == LV_COL_TEXT);
+	bool is_unicode = is_text && lvs.col.case_sensitive == SCS_INSENSITIVE_LOGICAL; // See LV_GeneralSort() for details.
+	UINT msg_lvm_getitem = is_unicode ? LVM_GETITEMW : LVM_GETITEM;
+	char *text = NULL, *new_text;
+	size_t text_length = 0, text_capacity = 0, field_size;
+	if (is_text)
+	{
+		text_capacity = aItemCount * 16; // An estimate that avoids most reallocations for typical fields.
+		if (   !(text = (char *)malloc(text_capacity))   )
+		{
+			free(key);
+			return false;
+		}
+	}
+
+	int i;
+	lvs.lvi.mask = LVIF_TEXT;
+	lvs.lvi.iSubItem = aColumnIndex;
+	for (i = 0; i < aItemCount; ++i)
+	{
+		key[i].row = i;
+		lvs.lvi.iItem = i;
+		lvs.lvi.pszText = lvs.buf1;
+		if (!SendMessage(aHwnd, msg_lvm_getitem, 0, (LPARAM)&lvs.lvi))
+			*(LPWSTR)lvs.buf1 = '\0'; // Treat it as blank (this also serves as an empty 8-bit string).
+		// Must use lvi.pszText vs. buf1 because LVM_GETITEM might have changed it to point elsewhere.
+		if (!is_text)
+		{
+			key[i].number = atof(lvs.lvi.pszText); // See LV_GeneralSort() for why atof() is used.
+			continue;
+		}
+		field_size = is_unicode ? (wcslen((LPCWSTR)lvs.lvi.pszText) + 1) * sizeof(WCHAR) : strlen(lvs.lvi.pszText) + 1; // Always even for Unicode, which keeps every field aligned.
+		if (text_length + field_size > text_capacity)
+		{
+			text_capacity = text_capacity * 2 + field_size;
+			// Use a temp var. because realloc() returns NULL on failure but leaves original block allocated.
+			if (   !(new_text = (char *)realloc(text, text_capacity))   )
+			{
+				free(text);
+				free(key);
+				return false;
+			}
+			text = new_text;
+		}
+		memcpy(text + text_length, lvs.lvi.pszText, field_size);
+		key[i].text_offset = text_length;
+		text_length += field_size;
+	}
+
+	sKeySortText = text;
+	sKeySortCol = lvs.col; // Struct copy.
+	sKeySortDirection = lvs.sort_ascending ? 1 : -1;
+	qsort((void *)key, aItemCount, sizeof(LV_SortKeyType), LV_KeySortCompare);
+
+	// Give each row its new position as its lParam, then let the control put them in that order:
+	lvs.lvi.mask = LVIF_PARAM;
+	lvs.lvi.iSubItem = 0; // Indicate that an item vs. subitem is being operated on (subitems can't have an lParam).
+	for (i = 0; i < aItemCount; ++i)
+	{
+		lvs.lvi.iItem = key[i].row;
+		lvs.lvi.lParam = i;
+		ListView_SetItem(aHwnd, &lvs.lvi);
+	}
+	free(text);
+	free(key);
+	SendMessage(aHwnd, LVM_SORTITEMS, TRUE, (LPARAM)LV_Int32Sort); // TRUE because the direction was already taken into account above.
+	return true;
+}
+
+
+
 void GuiType::LV_Sort(GuiControlType &aControl, int aColumnIndex, bool aSortOnlyIfEnabled, char aForceDirection)
 // aForceDirection should be 'A' to force ascending, 'D' to force ascending, or '\0' to use the column's
 // current default direction.
@@ -9378,6 +9819,14 @@ void GuiType::LV_Sort(GuiControlType &aControl, int aColumnIndex, bool aSortOnly
 		lvs.sort_ascending = (aColumnIndex == lv_attrib.sorted_by_col && !col.unidirectional)
 			? !lv_attrib.is_now_sorted_ascending : !col.prefer_descending;
 
+	if (lv_attrib.virt) // The rows are stored by us rather than the control, so sort them directly.
+	{
+		LV_VirtualSort(aControl, aColumnIndex, col, lvs.sort_ascending);
+		lv_attrib.sorted_by_col = aColumnIndex;
+		lv_attrib.is_now_sorted_ascending = lvs.sort_ascending;
+		return;
+	}
+
 	// Init those members needed for LVM_GETITEM if it turns out to be needed.  This section
 	// also serves to permanently init cchTextMax for use by the sorting functions too:
 	lvs.lvi.pszText = lvs.buf1;
@@ -9420,6 +9869,15 @@ void GuiType::LV_Sort(GuiControlType &aControl, int aColumnIndex, bool aSortOnly
 			else
 				col.case_sensitive = SCS_INSENSITIVE_LOCALE; // LV_GeneralSort() relies on this fallback.  Also, it falls back to the LOCALE method because it is the closest match to LOGICAL (since testing shows that StrCmpLogicalW seems to use the user's locale).
 		}
+		lvs.col = col; // Struct copy.  Both LV_KeySort() and LV_GeneralSort() rely on this.
+		if (LV_KeySort(aControl.hwnd, aColumnIndex, lvs, item_count))
+		{
+			lv_attrib.sorted_by_col = aColumnIndex;
+			lv_attrib.is_now_sorted_ascending = lvs.sort_ascending;
+			return;
+		}
+		// Otherwise, there wasn't enough memory to hold the keys, so fall back to the method below.  It
+		// needs no extra memory but retrieves the text of both items for every comparison.
 		// Since LVM_SORTITEMSEX requires comctl32.dll version 5.80+, the non-Ex version is used
 		// whenever the EX version fails to work.  One reason to strongly prefer the Ex version
 		// is that MSDN says the non-Ex version shouldn't query the control during the sort,
@@ -9464,6 +9922,390 @@ void GuiType::LV_Sort(GuiControlType &aControl, int aColumnIndex, bool aSortOnly
 
 
 
+// The following are used by LV_VirtualCompare() because qsort() provides no way to pass it a context.
+// This is safe because sorting never yields to other threads.
+static lv_virtual_type *sVirtualSortTarget;
+static int sVirtualSortColumn;
+static lv_col_type sVirtualSortCol;
+static int sVirtualSortDirection; // 1 for ascending, -1 for descending.
+
+int LV_VirtualCompare(const void *a1, const void *a2)
+// Compares two data rows of sVirtualSortTarget (passed as pointers to elements of its "order" array).
+{
+	lv_virtual_type &virt = *sVirtualSortTarget;
+	int row1 = *(int *)a1, row2 = *(int *)a2;
+	int result;
+	if (sVirtualSortCol.type == LV_COL_TEXT)
+	{
+		UINT *field = virt.field[sVirtualSortColumn]; // Caller has ensured it's non-NULL.
+		result = strcmp2(virt.text + field[row1], virt.text + field[row2], sVirtualSortCol.case_sensitive);
+	}
+	else
+	{
+		double *number = virt.number[sVirtualSortColumn]; // Caller has ensured it's non-NULL.
+		result = (number[row1] > number[row2]) ? 1 : (number[row1] == number[row2] ? 0 : -1);
+	}
+	if (result)
+		return result * sVirtualSortDirection;
+	// Otherwise, break the tie by original order of insertion.  This makes the outcome the same as a stable
+	// sort regardless of direction, which qsort() wouldn't otherwise guarantee.
+	return row1 - row2;
+}
+
+
+
+void GuiType::LV_VirtualSort(GuiControlType &aControl, int aColumnIndex, lv_col_type &aCol, bool aSortAscending)
+// Sorts a virtual ListView by rearranging its "order" array.  For numeric columns, each field is converted
+// to a number only once and the result is cached until the column is changed, which makes subsequent sorts
+// (such as reversing the direction) much faster.  Caller has ensured aColumnIndex is in bounds.
+{
+	lv_virtual_type &virt = *aControl.union_lv_attrib->virt;
+	if (virt.row_count < 2 || !virt.field[aColumnIndex]) // Nothing to sort (a column with no text has all fields empty).
+		return;
+	UINT *field = virt.field[aColumnIndex];
+	int i;
+	if (aCol.type != LV_COL_TEXT && !virt.number[aColumnIndex])
+	{
+		if (   !(virt.number[aColumnIndex] = (double *)malloc(virt.data_capacity * sizeof(double)))   )
+			return; // Short on memory, so leave it unsorted.
+		double *number = virt.number[aColumnIndex];
+		for (i = 0; i < virt.data_count; ++i)
+			// See LV_Sort() and LV_GeneralSort() for why ATOI() and atof() are used:
+			number[i] = (aCol.type == LV_COL_INTEGER) ? (double)ATOI(virt.text + field[i]) : atof(virt.text + field[i]);
+	}
+
+	// Remember which data rows are selected and focused so that the same rows (rather than the same row
+	// numbers) can be selected afterward, which is how a non-virtual ListView behaves.  This is done via
+	// a temporary marker for each data row so that the cost is proportional to the number of rows rather
+	// than the number of rows times the number of selected rows.
+	#define LV_VIRTUAL_SELECTED 0x01
+	#define LV_VIRTUAL_FOCUSED  0x02
+	char *marker = (char *)calloc(virt.data_count, 1); // If this fails, the selection is simply lost.
+	int selected_count = 0;
+	if (marker)
+	{
+		for (i = -1; (i = ListView_GetNextItem(aControl.hwnd, i, LVNI_SELECTED)) > -1 && i < virt.row_count; ++selected_count)
+			marker[virt.order[i]] |= LV_VIRTUAL_SELECTED;
+		if ((i = ListView_GetNextItem(aControl.hwnd, -1, LVNI_FOCUSED)) > -1 && i < virt.row_count)
+			marker[virt.order[i]] |= LV_VIRTUAL_FOCUSED;
+	}
+
+	sVirtualSortTarget = &virt;
+	sVirtualSortColumn = aColumnIndex;
+	sVirtualSortCol = aCol; // Struct copy.
+	if (sVirtualSortCol.case_sensitive == SCS_INSENSITIVE_LOGICAL) // Not supported for virtual ListViews because it would require converting every field to Unicode.
+		sVirtualSortCol.case_sensitive = SCS_INSENSITIVE_LOCALE; // The closest match, as in LV_Sort().
+	sVirtualSortDirection = aSortAscending ? 1 : -1;
+	qsort((void *)virt.order, virt.row_count, sizeof(int), LV_VirtualCompare);
+
+	if (marker)
+	{
+		if (selected_count)
+			ListView_SetItemState(aControl.hwnd, -1, 0, LVIS_SELECTED); // Deselect all.
+		for (i = 0; i < virt.row_count; ++i)
+			if (marker[virt.order[i]])
+				ListView_SetItemState(aControl.hwnd, i
+					, ((marker[virt.order[i]] & LV_VIRTUAL_SELECTED) ? LVIS_SELECTED : 0) | ((marker[virt.order[i]] & LV_VIRTUAL_FOCUSED) ? LVIS_FOCUSED : 0)
+					, LVIS_SELECTED | LVIS_FOCUSED);
+		free(marker);
+	}
+	InvalidateRect(aControl.hwnd, NULL, FALSE);
+}
+
+
+
+bool GuiType::LV_VirtualReserve(lv_virtual_type &aVirt, int aRowCount, size_t aTextLength)
+// Ensures there is room for aRowCount more data rows and aTextLength more bytes of text without further
+// reallocation.  Returns false if out of memory (in which case any arrays that were already grown stay that
+// way, which is harmless).
+{
+	int new_capacity = aVirt.data_count + aRowCount;
+	if (new_capacity > aVirt.data_capacity)
+	{
+		if (new_capacity < aVirt.data_capacity * 2) // Grow exponentially so that adding rows one at a time is fast.
+			new_capacity = aVirt.data_capacity * 2;
+		if (new_capacity < 64)
+			new_capacity = 64;
+		// Use a temp var. because realloc() returns NULL on failure but leaves original block allocated.
+		void *new_mem;
+		if (   !(new_mem = realloc(aVirt.order, new_capacity * sizeof(int)))   )
+			return false;
+		aVirt.order = (int *)new_mem;
+		for (int col = 0; col < LV_MAX_COLUMNS; ++col)
+		{
+			if (aVirt.field[col])
+			{
+				if (   !(new_mem = realloc(aVirt.field[col], new_capacity * sizeof(UINT)))   )
+					return false;
+				aVirt.field[col] = (UINT *)new_mem;
+			}
+			if (aVirt.number[col]) // Rather than growing it, discard it since it will be rebuilt by the next sort anyway.
+			{
+				free(aVirt.number[col]);
+				aVirt.number[col] = NULL;
+			}
+		}
+		// Only now that all arrays have been grown is it safe to update the capacity.
+		aVirt.data_capacity = new_capacity;
+	}
+	size_t new_text_capacity = aVirt.text_length + aTextLength + (aVirt.text ? 0 : 1); // +1 for the empty string at text[0].
+	if (new_text_capacity > aVirt.text_capacity)
+	{
+		if (new_text_capacity < aVirt.text_capacity * 2)
+			new_text_capacity = aVirt.text_capacity * 2;
+		if (new_text_capacity < 4096)
+			new_text_capacity = 4096;
+		char *new_text;
+		if (   !(new_text = (char *)realloc(aVirt.text, new_text_capacity))   )
+			return false;
+		if (!aVirt.text) // This is the first allocation, so reserve offset 0 as the empty string.
+		{
+			*new_text = '\0';
+			aVirt.text_length = 1;
+		}
+		aVirt.text = new_text;
+		aVirt.text_capacity = new_text_capacity;
+	}
+	return true;
+}
+
+
+
+int GuiType::LV_VirtualInsertRow(lv_virtual_type &aVirt, int aRowIndex)
+// Inserts a blank row at aRowIndex (or appends it if aRowIndex is beyond the last row).
+// Returns the index of the new row, or -1 if out of memory.  The caller is responsible for telling the
+// control about the new row count.
+{
+	if (aVirt.data_count >= aVirt.data_capacity || !aVirt.text)
+		if (!LV_VirtualReserve(aVirt, 1, 0))
+			return -1;
+	int data_row = aVirt.data_count++;
+	for (int col = 0; col < LV_MAX_COLUMNS; ++col)
+	{
+		if (aVirt.field[col])
+			aVirt.field[col][data_row] = 0; // The empty string.
+		if (aVirt.number[col])
+			aVirt.number[col][data_row] = 0.0; // Matches what ATOI()/atof() yield for the empty string.
+	}
+	if (aRowIndex < 0 || aRowIndex > aVirt.row_count)
+		aRowIndex = aVirt.row_count;
+	if (aRowIndex < aVirt.row_count)
+		memmove(aVirt.order + aRowIndex + 1, aVirt.order + aRowIndex, (aVirt.row_count - aRowIndex) * sizeof(int));
+	aVirt.order[aRowIndex] = data_row;
+	++aVirt.row_count;
+	return aRowIndex;
+}
+
+
+
+// The arena is compacted once its orphaned text exceeds both of the following, which keeps the cost of
+// compacting proportional to the amount of text that has been replaced or deleted:
+#define LV_VIRTUAL_COMPACT_MIN_ORPHANED (64 * 1024)
+#define LV_VIRTUAL_COMPACT_IF_NEEDED(virt) \
+	if ((virt).text_orphaned > LV_VIRTUAL_COMPACT_MIN_ORPHANED && (virt).text_orphaned > (virt).text_length / 2)\
+		LV_VirtualCompact(virt); // Failure is harmless; it will be tried again next time.
+
+bool GuiType::LV_VirtualSetText(lv_virtual_type &aVirt, int aRowIndex, int aColumnIndex, char *aText)
+// Returns false if the row or column doesn't exist or there is insufficient memory.
+// If the new text fits in the space occupied by the old text, it is written over it.  Otherwise, the old
+// text is orphaned until the arena is compacted.
+{
+	if (aRowIndex < 0 || aRowIndex >= aVirt.row_count || aColumnIndex < 0 || aColumnIndex >= LV_MAX_COLUMNS)
+		return false;
+	int data_row = aVirt.order[aRowIndex];
+	UINT *&field = aVirt.field[aColumnIndex];
+	size_t length = strlen(aText);
+	size_t old_length = (field && field[data_row]) ? strlen(aVirt.text + field[data_row]) : 0;
+	if (!*aText)
+	{
+		if (field && field[data_row])
+		{
+			aVirt.text_orphaned += old_length + 1;
+			field[data_row] = 0; // The empty string.
+		}
+	}
+	else if (length <= old_length) // Reuse the old text's space (the remainder of it, if any, is orphaned).
+	{
+		memcpy(aVirt.text + field[data_row], aText, length + 1);
+		aVirt.text_orphaned += old_length - length;
+	}
+	else
+	{
+		if (!LV_VirtualReserve(aVirt, 0, length + 1) || aVirt.text_length + length + 1 > UINT_MAX) // The latter is checked because offsets are 32-bit.
+			return false;
+		if (old_length)
+			aVirt.text_orphaned += old_length + 1;
+		if (!field)
+		{
+			if (   !(field = (UINT *)calloc(aVirt.data_capacity, sizeof(UINT)))   ) // Zero is the empty string.
+				return false;
+		}
+		memcpy(aVirt.text + aVirt.text_length, aText, length + 1);
+		field[data_row] = (UINT)aVirt.text_length;
+		aVirt.text_length += length + 1;
+	}
+	if (aVirt.number[aColumnIndex]) // Invalidate the cached numbers since one of them is now out-of-date.
+	{
+		free(aVirt.number[aColumnIndex]);
+		aVirt.number[aColumnIndex] = NULL;
+	}
+	LV_VIRTUAL_COMPACT_IF_NEEDED(aVirt)
+	return true;
+}
+
+
+
+char *GuiType::LV_VirtualGetText(lv_virtual_type &aVirt, int aRowIndex, int aColumnIndex)
+// Returns the text of the specified field, or "" if it doesn't exist.
+{
+	if (aRowIndex < 0 || aRowIndex >= aVirt.row_count || aColumnIndex < 0 || aColumnIndex >= LV_MAX_COLUMNS
+		|| !aVirt.field[aColumnIndex])
+		return "";
+	return aVirt.text + aVirt.field[aColumnIndex][aVirt.order[aRowIndex]];
+}
+
+
+
+void GuiType::LV_VirtualDeleteRow(lv_virtual_type &aVirt, int aRowIndex)
+// The row's text is orphaned rather than reclaimed immediately (see LV_VirtualCompact()).
+{
+	if (aRowIndex < 0 || aRowIndex >= aVirt.row_count)
+		return;
+	int data_row = aVirt.order[aRowIndex];
+	for (int col = 0; col < LV_MAX_COLUMNS; ++col)
+		if (aVirt.field[col] && aVirt.field[col][data_row])
+			aVirt.text_orphaned += strlen(aVirt.text + aVirt.field[col][data_row]) + 1;
+	--aVirt.row_count;
+	if (aRowIndex < aVirt.row_count)
+		memmove(aVirt.order + aRowIndex, aVirt.order + aRowIndex + 1, (aVirt.row_count - aRowIndex) * sizeof(int));
+	LV_VIRTUAL_COMPACT_IF_NEEDED(aVirt)
+}
+
+
+
+bool GuiType::LV_VirtualCompact(lv_virtual_type &aVirt)
+// Rebuilds the arena and the column arrays so that they contain only the rows that still exist (in their
+// displayed order), which reclaims the text orphaned by LV_VirtualSetText() and LV_VirtualDeleteRow().
+// Returns false if there is insufficient memory, in which case nothing is changed.
+{
+	int row, col, data_row;
+	UINT offset;
+	size_t new_length = 1; // Offset 0 is reserved for the empty string.
+	for (row = 0; row < aVirt.row_count; ++row)
+	{
+		data_row = aVirt.order[row];
+		for (col = 0; col < LV_MAX_COLUMNS; ++col)
+			if (aVirt.field[col] && (offset = aVirt.field[col][data_row]))
+				new_length += strlen(aVirt.text + offset) + 1;
+	}
+	char *new_text;
+	if (   !(new_text = (char *)malloc(new_length))   )
+		return false;
+	UINT *new_field[LV_MAX_COLUMNS];
+	for (col = 0; col < LV_MAX_COLUMNS; ++col)
+	{
+		new_field[col] = NULL;
+		if (aVirt.field[col] && !(new_field[col] = (UINT *)malloc(aVirt.data_capacity * sizeof(UINT))))
+		{
+			while (col > 0)
+				free(new_field[--col]); // free() does nothing when given NULL.
+			free(new_text);
+			return false;
+		}
+	}
+	// Since above didn't return, there's enough memory to proceed.
+	size_t length;
+	*new_text = '\0';
+	new_length = 1;
+	for (row = 0; row < aVirt.row_count; ++row)
+	{
+		data_row = aVirt.order[row];
+		for (col = 0; col < LV_MAX_COLUMNS; ++col)
+		{
+			if (!new_field[col])
+				continue;
+			if (offset = aVirt.field[col][data_row])
+			{
+				length = strlen(aVirt.text + offset) + 1;
+				memcpy(new_text + new_length, aVirt.text + offset, length);
+				new_field[col][row] = (UINT)new_length;
+				new_length += length;
+			}
+			else
+				new_field[col][row] = 0; // The empty string.
+		}
+		aVirt.order[row] = row; // Safe because data_row was fetched above and no later row refers to this element.
+	}
+	for (col = 0; col < LV_MAX_COLUMNS; ++col)
+	{
+		free(aVirt.field[col]);
+		aVirt.field[col] = new_field[col];
+		if (aVirt.number[col]) // The data rows have been renumbered, so discard these; the next sort rebuilds them.
+		{
+			free(aVirt.number[col]);
+			aVirt.number[col] = NULL;
+		}
+	}
+	free(aVirt.text);
+	aVirt.text = new_text;
+	aVirt.text_length = new_length;
+	aVirt.text_capacity = new_length;
+	aVirt.text_orphaned = 0;
+	aVirt.data_count = aVirt.row_count;
+	return true;
+}
+
+
+
+void GuiType::LV_VirtualDeleteAll(lv_virtual_type &aVirt)
+// Frees all rows and their text, but retains the struct itself so that the ListView remains virtual.
+{
+	for (int col = 0; col < LV_MAX_COLUMNS; ++col)
+	{
+		free(aVirt.field[col]); // free() does nothing when given NULL.
+		free(aVirt.number[col]);
+	}
+	free(aVirt.order);
+	free(aVirt.text);
+	ZeroMemory(&aVirt, sizeof(lv_virtual_type));
+}
+
+
+
+void GuiType::LV_VirtualInsertDeleteCol(lv_virtual_type &aVirt, int aColumnIndex, bool aInsert)
+// Keeps the column arrays in sync with the control's columns after one has been inserted or deleted, in the
+// same way that BIF_LV_InsertModifyDeleteCol() maintains lv_attrib.col.
+{
+	if (aColumnIndex < 0 || aColumnIndex >= LV_MAX_COLUMNS)
+		return;
+	int count_to_move = LV_MAX_COLUMNS - aColumnIndex - 1;
+	if (aInsert)
+	{
+		// Discard the last column, which has no room to move right (realistically never has any data):
+		free(aVirt.field[LV_MAX_COLUMNS - 1]);
+		free(aVirt.number[LV_MAX_COLUMNS - 1]);
+		memmove(aVirt.field + aColumnIndex + 1, aVirt.field + aColumnIndex, count_to_move * sizeof(UINT *));
+		memmove(aVirt.number + aColumnIndex + 1, aVirt.number + aColumnIndex, count_to_move * sizeof(double *));
+		aVirt.field[aColumnIndex] = NULL; // The new column's fields are all empty.
+		aVirt.number[aColumnIndex] = NULL;
+	}
+	else
+	{
+		if (UINT *field = aVirt.field[aColumnIndex]) // Account for the text the deleted column's fields occupied.
+			for (int row = 0; row < aVirt.row_count; ++row)
+				if (field[aVirt.order[row]])
+					aVirt.text_orphaned += strlen(aVirt.text + field[aVirt.order[row]]) + 1;
+		free(aVirt.field[aColumnIndex]);
+		free(aVirt.number[aColumnIndex]);
+		memmove(aVirt.field + aColumnIndex, aVirt.field + aColumnIndex + 1, count_to_move * sizeof(UINT *));
+		memmove(aVirt.number + aColumnIndex, aVirt.number + aColumnIndex + 1, count_to_move * sizeof(double *));
+		aVirt.field[LV_MAX_COLUMNS - 1] = NULL;
+		aVirt.number[LV_MAX_COLUMNS - 1] = NULL;
+	}
+}
+
+
+
 DWORD GuiType::ControlGetListViewMode(HWND aWnd)
 // Caller has ensured that aWnd is non-NULL and a valid ListView control.
 // Returns one of the following:
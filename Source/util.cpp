@@ -78,15 +78,123 @@ int GetISOWeekNumber(char *aBuf, int aYear, int aYDay, int aWDay)
 
 
 
-ResultType YYYYMMDDToFileTime(char *aYYYYMMDD, FILETIME &aFileTime)
+// The civil-date functions below convert between a Gregorian date and a count of days using nothing but
+// integer arithmetic (the days_from_civil/civil_from_days method published by Howard Hinnant).  Day zero
+// is 1601-01-01 so that seconds (or 100-nanosecond ticks) computed from it line up exactly with a local
+// FILETIME.  This lets EnvAdd/EnvSub and the YYYYMMDD conversions avoid a round trip through
+// SystemTimeToFileTime() and FileTimeToSystemTime() for every operation.
+#define CIVIL_DAYS_1601_TO_1970 134774 // Number of days from 1601-01-01 to 1970-01-01.
+
+int DaysFromCivil(int aYear, int aMonth, int aDay)
+// Returns the number of days from 1601-01-01 until the specified date (negative for earlier dates).
+// Caller must ensure that aMonth is between 1 and 12.  aDay is not validated, so a day beyond the
+// end of the month simply overflows into the next month.
+{
+	aYear -= aMonth <= 2; // Treat Jan and Feb as months 11 and 12 of the prior year so that Feb 29 falls at the end.
+	int era = (aYear >= 0 ? aYear : aYear - 399) / 400;
+	int year_of_era = aYear - era * 400;                                             // [0, 399]
+	int day_of_year = (153 * (aMonth + (aMonth > 2 ? -3 : 9)) + 2) / 5 + aDay - 1; // [0, 365]
+	int day_of_era = year_of_era * 365 + year_of_era/4 - year_of_era/100 + day_of_year; // [0, 146096]
+	return era * 146097 + day_of_era - 719468 + CIVIL_DAYS_1601_TO_1970; // 719468 is 0000-03-01 to 1970-01-01.
+}
+
+
+
+void CivilFromDays(int aDays, int &aYear, int &aMonth, int &aDay)
+// The inverse of DaysFromCivil(): aDays is the number of days since 1601-01-01.
+{
+	aDays += 719468 - CIVIL_DAYS_1601_TO_1970; // Shift the epoch to 0000-03-01.
+	int era = (aDays >= 0 ? aDays : aDays - 146096) / 146097;
+	int day_of_era = aDays - era * 146097;                                                   // [0, 146096]
+	int year_of_era = (day_of_era - day_of_era/1460 + day_of_era/36524 - day_of_era/146096) / 365; // [0, 399]
+	int day_of_year = day_of_era - (365 * year_of_era + year_of_era/4 - year_of_era/100);      // [0, 365]
+	int month_index = (5 * day_of_year + 2) / 153;                                             // [0, 11], March-based.
+	aDay = day_of_year - (153 * month_index + 2) / 5 + 1;
+	aMonth = month_index < 10 ? month_index + 3 : month_index - 9;
+	aYear = year_of_era + era * 400 + (aMonth <= 2);
+}
+
+
+
+bool SystemTimeIsValid(SYSTEMTIME &aTime)
+// Performs the same validation as SystemTimeToFileTime() but without calling the OS.  This includes
+// rejecting years earlier than 1601, which for simplicity is enforced globally throughout the program
+// since none of the Windows API calls seem to support earlier years.  wDayOfWeek is ignored.
+{
+	static const char sDaysInMonth[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+	if (aTime.wYear < 1601 || aTime.wYear > 30827 || aTime.wMonth < 1 || aTime.wMonth > 12
+		|| aTime.wDay < 1 || aTime.wHour > 23 || aTime.wMinute > 59 || aTime.wSecond > 59
+		|| aTime.wMilliseconds > 999)
+		return false;
+	return aTime.wDay <= sDaysInMonth[aTime.wMonth - 1]
+		|| aTime.wMonth == 2 && aTime.wDay == 29 && IS_LEAP_YEAR(aTime.wYear);
+}
+
+
+
+ResultType YYYYMMDDToSeconds(char *aYYYYMMDD, __int64 &aSeconds)
+// Sets aSeconds to the number of seconds from 1601-01-01 00:00:00 until aYYYYMMDD (no time zone
+// conversion is done).  Returns FAIL for exactly the same strings that YYYYMMDDToFileTime() rejects.
 {
 	SYSTEMTIME st;
 	YYYYMMDDToSystemTime(aYYYYMMDD, st, false);  // "false" because it's validated below.
+	if (!SystemTimeIsValid(st))
+		return FAIL;
+	aSeconds = (__int64)DaysFromCivil(st.wYear, st.wMonth, st.wDay) * (60 * 60 * 24)
+		+ st.wHour * (60 * 60) + st.wMinute * 60 + st.wSecond;
+	return OK;
+}
+
+
+
+char *SecondsToYYYYMMDD(char *aBuf, __int64 aSeconds)
+// The inverse of YYYYMMDDToSeconds().  Returns aBuf, which is made blank if aSeconds is outside the
+// range that a FILETIME can represent (i.e. the same cases in which FileTimeToSystemTime() would fail).
+{
+	if (aSeconds < 0 || aSeconds > MAX_FILETIME_SECONDS)
+	{
+		*aBuf = '\0';
+		return aBuf;
+	}
+	int year, month, day;
+	CivilFromDays((int)(aSeconds / (60 * 60 * 24)), year, month, day);
+	int seconds_of_day = (int)(aSeconds % (60 * 60 * 24));
+	SYSTEMTIME st;
+	st.wYear = year;
+	st.wMonth = month;
+	st.wDay = day;
+	st.wHour = seconds_of_day / (60 * 60);
+	st.wMinute = seconds_of_day / 60 % 60;
+	st.wSecond = seconds_of_day % 60;
+	return SystemTimeToYYYYMMDD(aBuf, st);
+}
+
+
+
+__int64 GetLocalTimeTicks()
+// Returns the current local time as the number of 100-nanosecond intervals since 1601 (i.e. a local
+// FILETIME), for callers who substitute the current time for a blank date-time string.
+{
+	FILETIME ftNowUTC, ftNow;
+	GetSystemTimeAsFileTime(&ftNowUTC);
+	FileTimeToLocalFileTime(&ftNowUTC, &ftNow);  // Convert UTC to local time.
+	return ((__int64)ftNow.dwHighDateTime << 32) | ftNow.dwLowDateTime;
+}
+
+
+
+ResultType YYYYMMDDToFileTime(char *aYYYYMMDD, FILETIME &aFileTime)
+{
+	__int64 seconds;
 	// This will return failure if aYYYYMMDD contained any invalid elements, such as an
-	// explicit zero for the day of the month.  It also reports failure if st.wYear is
-	// less than 1601, which for simplicity is enforced globally throughout the program
-	// since none of the Windows API calls seem to support earlier years.
-	return SystemTimeToFileTime(&st, &aFileTime) ? OK : FAIL; // The st.wDayOfWeek member is ignored.
+	// explicit zero for the day of the month, or a year less than 1601.
+	if (!YYYYMMDDToSeconds(aYYYYMMDD, seconds))
+		return FAIL;
+	ULARGE_INTEGER ul;
+	ul.QuadPart = seconds * 10000000; // Convert to tenths-of-microsecond.
+	aFileTime.dwLowDateTime = ul.LowPart;
+	aFileTime.dwHighDateTime = ul.HighPart;
+	return OK;
 }
 
 
@@ -204,18 +312,10 @@ ResultType YYYYMMDDToSystemTime(char *aYYYYMMDD, SYSTEMTIME &aSystemTime, bool a
 		aSystemTime.wDayOfWeek = (y + y/4 - y/100 + y/400 + t[aSystemTime.wMonth-1] + aSystemTime.wDay) % 7;
 	}
 
-	if (aDoValidate)
-	{
-		FILETIME ft;
-		// This will return failure if aYYYYMMDD contained any invalid elements, such as an
-		// explicit zero for the day of the month.  It also reports failure if st.wYear is
-		// less than 1601, which for simplicity is enforced globally throughout the program
-		// since none of the Windows API calls seem to support earlier years.
-		return SystemTimeToFileTime(&aSystemTime, &ft) ? OK : FAIL;
-		// Above: The st.wDayOfWeek member is ignored by the above (but might be used by our caller), but
-		// that's okay because it shouldn't need validation.
-	}
-	return OK;
+	// This will return failure if aYYYYMMDD contained any invalid elements, such as an
+	// explicit zero for the day of the month, or a year less than 1601.  wDayOfWeek is
+	// ignored (but might be used by our caller), which is okay because it's always in range.
+	return (!aDoValidate || SystemTimeIsValid(aSystemTime)) ? OK : FAIL;
 }
 
 
@@ -228,11 +328,8 @@ char *FileTimeToYYYYMMDD(char *aBuf, FILETIME &aTime, bool aConvertToLocalTime)
 		FileTimeToLocalFileTime(&aTime, &ft); // MSDN says that target cannot be the same var as source.
 	else
 		memcpy(&ft, &aTime, sizeof(FILETIME));  // memcpy() might be less code size that a struct assignment, ft = aTime.
-	SYSTEMTIME st;
-	if (FileTimeToSystemTime(&ft, &st))
-		return SystemTimeToYYYYMMDD(aBuf, st);
-	*aBuf = '\0';
-	return aBuf;
+	// Cast to signed so that values FileTimeToSystemTime() would reject (high bit set) yield a blank result:
+	return SecondsToYYYYMMDD(aBuf, (__int64)(((ULONGLONG)ft.dwHighDateTime << 32) | ft.dwLowDateTime) / 10000000);
 }
 
 
@@ -243,9 +340,25 @@ char *SystemTimeToYYYYMMDD(char *aBuf, SYSTEMTIME &aTime)
 // on Win9x apparently results in an invalid time because the function is implemented only as a stub on
 // those OSes.
 {
-	sprintf(aBuf, "%04d%02d%02d" "%02d%02d%02d"
-		, aTime.wYear, aTime.wMonth, aTime.wDay
-		, aTime.wHour, aTime.wMinute, aTime.wSecond);
+	if (aTime.wYear > 9999 || aTime.wMonth > 99 || aTime.wDay > 99 // Rare or invalid, so let sprintf() handle the widths.
+		|| aTime.wHour > 99 || aTime.wMinute > 99 || aTime.wSecond > 99)
+	{
+		sprintf(aBuf, "%04d%02d%02d" "%02d%02d%02d"
+			, aTime.wYear, aTime.wMonth, aTime.wDay
+			, aTime.wHour, aTime.wMinute, aTime.wSecond);
+		return aBuf;
+	}
+	// Otherwise, write the digits directly since this is called for every file by file-loops that
+	// retrieve A_LoopFileTimeModified, etc., and sprintf() is comparatively slow.
+	#define PUT_2_DIGITS(cp, n) ((cp)[0] = '0' + (n) / 10, (cp)[1] = '0' + (n) % 10)
+	PUT_2_DIGITS(aBuf, aTime.wYear / 100);
+	PUT_2_DIGITS(aBuf + 2, aTime.wYear % 100);
+	PUT_2_DIGITS(aBuf + 4, aTime.wMonth);
+	PUT_2_DIGITS(aBuf + 6, aTime.wDay);
+	PUT_2_DIGITS(aBuf + 8, aTime.wHour);
+	PUT_2_DIGITS(aBuf + 10, aTime.wMinute);
+	PUT_2_DIGITS(aBuf + 12, aTime.wSecond);
+	aBuf[14] = '\0';
 	return aBuf;
 }
 
@@ -258,30 +371,28 @@ __int64 YYYYMMDDSecondsUntil(char *aYYYYMMDDStart, char *aYYYYMMDDEnd, bool &aFa
 	aFailed = true;  // Set default for output parameter, in case of early return.
 	if (!aYYYYMMDDStart || !aYYYYMMDDEnd) return 0;
 
-	FILETIME ftStart, ftEnd, ftNowUTC;
+	// Work in 100-nanosecond ticks so that the current time's fractional second is taken into account
+	// the same way FileTimeSecondsUntil() would:
+	__int64 start, end;
 
 	if (*aYYYYMMDDStart)
 	{
-		if (!YYYYMMDDToFileTime(aYYYYMMDDStart, ftStart))
+		if (!YYYYMMDDToSeconds(aYYYYMMDDStart, start))
 			return 0;
+		start *= 10000000;
 	}
 	else // Use the current time in its place.
-	{
-		GetSystemTimeAsFileTime(&ftNowUTC);
-		FileTimeToLocalFileTime(&ftNowUTC, &ftStart);  // Convert UTC to local time.
-	}
+		start = GetLocalTimeTicks();
 	if (*aYYYYMMDDEnd)
 	{
-		if (!YYYYMMDDToFileTime(aYYYYMMDDEnd, ftEnd))
+		if (!YYYYMMDDToSeconds(aYYYYMMDDEnd, end))
 			return 0;
+		end *= 10000000;
 	}
 	else // Use the current time in its place.
-	{
-		GetSystemTimeAsFileTime(&ftNowUTC);
-		FileTimeToLocalFileTime(&ftNowUTC, &ftEnd);  // Convert UTC to local time.
-	}
+		end = GetLocalTimeTicks();
 	aFailed = false;  // Indicate success.
-	return FileTimeSecondsUntil(&ftStart, &ftEnd);
+	return (end - start) / 10000000; // Convert from tenths-of-microsecond.
 }
 
 
@@ -1281,6 +1392,38 @@ bool DoesFilePatternExist(char *aFilePattern, DWORD *aFileAttr)
 
 
 
+HANDLE FindFirstFileBatched(char *aFilePattern, WIN32_FIND_DATA &aFindData, bool aDirectoriesOnly)
+// Same as FindFirstFile() except that on OSes that support it, each subsequent FindNextFile() retrieves
+// the directory's entries from the file system in larger batches.  This greatly reduces the number of
+// round trips for folders that contain many files, especially on network drives.  If aDirectoriesOnly
+// is true, the file system is told that the caller is only interested in folders; but since that's
+// merely a hint that many file systems ignore, the caller must still check each item's attributes.
+{
+	// The program won't launch at all on Win95 unless the function address is resolved at runtime:
+	typedef HANDLE (WINAPI *MyFindFirstFileExType)(LPCSTR, FINDEX_INFO_LEVELS, LPVOID, FINDEX_SEARCH_OPS, LPVOID, DWORD);
+	static MyFindFirstFileExType MyFindFirstFileEx = (MyFindFirstFileExType)GetProcAddress(GetModuleHandle("kernel32")
+		, "FindFirstFileExA");
+	#ifndef FIND_FIRST_EX_LARGE_FETCH
+		#define FIND_FIRST_EX_LARGE_FETCH 2 // Not defined by older SDKs.
+	#endif
+	// OSes older than Windows 7 reject FIND_FIRST_EX_LARGE_FETCH with ERROR_INVALID_PARAMETER.  Once that
+	// happens, stop passing the flag so that each call doesn't have to fail once before succeeding:
+	static DWORD sAdditionalFlags = FIND_FIRST_EX_LARGE_FETCH;
+
+	if (!MyFindFirstFileEx)
+		return FindFirstFile(aFilePattern, &aFindData);
+	FINDEX_SEARCH_OPS search_op = aDirectoriesOnly ? FindExSearchLimitToDirectories : FindExSearchNameMatch;
+	HANDLE file_search = MyFindFirstFileEx(aFilePattern, FindExInfoStandard, &aFindData, search_op, NULL, sAdditionalFlags);
+	if (file_search == INVALID_HANDLE_VALUE && sAdditionalFlags && GetLastError() == ERROR_INVALID_PARAMETER)
+	{
+		sAdditionalFlags = 0;
+		file_search = MyFindFirstFileEx(aFilePattern, FindExInfoStandard, &aFindData, search_op, NULL, 0);
+	}
+	return file_search;
+}
+
+
+
 #ifdef _DEBUG
 ResultType FileAppend(char *aFilespec, char *aLine, bool aAppendNewline)
 {
@@ -1415,6 +1558,24 @@ unsigned __int64 GetFileSize64(HANDLE aFileHandle)
 
 
 
+unsigned __int64 GetTickCount64Ex()
+// Returns a 64-bit version of GetTickCount() that doesn't wrap around every 49.7 days.  GetTickCount64()
+// isn't used because it requires Vista or later.  The wraparound is detected by comparing against the
+// previous call, so this must be called at least once every 49.7 days to stay accurate (which is always
+// the case while there are any enabled timers, since the main timer calls it every SLEEP_INTERVAL).
+// Only the main thread should call this since its static data isn't protected by a lock.
+{
+	static DWORD sPrevTick = 0;
+	static unsigned __int64 sHighPart = 0;
+	DWORD tick = GetTickCount();
+	if (tick < sPrevTick) // The 32-bit tick count wrapped around since the last call.
+		sHighPart += ((unsigned __int64)1 << 32);
+	sPrevTick = tick;
+	return sHighPart | tick;
+}
+
+
+
 char *GetLastErrorText(char *aBuf, int aBufSize, bool aUpdateLastError)
 // aBufSize is an int to preserve any negative values the caller might pass in.
 {
@@ -1734,8 +1895,9 @@ void FreeInterProcMem(HANDLE aHandle, LPVOID aMem)
 
 
 
-HBITMAP LoadPicture(char *aFilespec, int aWidth, int aHeight, int &aImageType, int aIconNumber
+static HBITMAP LoadPictureFromFile(char *aFilespec, int aWidth, int aHeight, int &aImageType, int aIconNumber
 	, bool aUseGDIPlusIfAvailable)
+// This is the uncached part of LoadPicture().
 // Returns NULL on failure.
 // If aIconNumber > 0, an HICON or HCURSOR is returned (both should be interchangeable), never an HBITMAP.
 // However, aIconNumber==1 is treated as a special icon upon which LoadImage is given preference over ExtractIcon
@@ -2128,6 +2290,150 @@ HBITMAP LoadPicture(char *aFilespec, int aWidth, int aHeight, int &aImageType, i
 
 
 
+// LoadPicture() keeps a private copy of each bitmap it loads so that a script which repeatedly shows the
+// same images (e.g. a GUI that cycles a Picture control through a set of images, or an ImageSearch in a
+// loop) doesn't have to re-read and re-decode the file each time.  Decoding a JPG/GIF/PNG via GDI+ or
+// OleLoadPicture() is far more expensive than copying an already-decoded bitmap.  Each entry is keyed by
+// the file's full path, last-write time and size (so that changes to the file are noticed), plus the
+// parameters that affect the result.  Icons and cursors are not cached because CopyImage() would lose
+// any animation they have, and LoadImage() loads them quickly anyway.
+#define PICTURE_CACHE_SIZE 64
+#define PICTURE_CACHE_MAX_BYTES (16 * 1024 * 1024) // Upper limit on the total size of the cached bitmaps' pixels.
+struct PictureCacheEntry
+{
+	HBITMAP hbitmap; // The cached copy, which is never given to callers (they get a copy of it instead).
+	DWORD bytes; // Approximate size of the bitmap's pixels.
+	DWORD last_used; // Value of sPictureCacheClock when this entry was last used, for LRU eviction.
+	FILETIME last_write_time;
+	DWORD file_size_low, file_size_high;
+	int width, height; // The dimensions the caller requested, not necessarily the bitmap's actual size.
+	bool use_gdi_plus;
+	bool is_dib; // Whether hbitmap is a DIB section, so that copies are made the same way.
+	char filespec[MAX_PATH]; // Full path.
+};
+static PictureCacheEntry sPictureCache[PICTURE_CACHE_SIZE];
+static int sPictureCacheCount = 0;
+static DWORD sPictureCacheBytes = 0, sPictureCacheClock = 0;
+static DWORD sPictureCacheHits = 0, sPictureCacheMisses = 0;
+
+
+
+static void PictureCacheRemove(int aIndex)
+{
+	DeleteObject(sPictureCache[aIndex].hbitmap);
+	sPictureCacheBytes -= sPictureCache[aIndex].bytes;
+	--sPictureCacheCount;
+	if (aIndex < sPictureCacheCount) // Order doesn't matter, so just move the last entry into the vacated slot.
+		sPictureCache[aIndex] = sPictureCache[sPictureCacheCount];
+}
+
+
+
+static void PictureCacheAdd(HBITMAP aBitmap, char *aFullPath, WIN32_FILE_ATTRIBUTE_DATA &aFileData
+	, int aWidth, int aHeight, bool aUseGDIPlusIfAvailable)
+// Adds a copy of aBitmap (which remains owned by the caller) to the cache, evicting the least
+// recently used entries as needed to stay within the limits.
+{
+	DIBSECTION ds;
+	int object_size = GetObject(aBitmap, sizeof(ds), &ds); // Retrieves only the BITMAP part if it isn't a DIB section.
+	if (!object_size)
+		return;
+	bool is_dib = (object_size == sizeof(ds));
+	DWORD bytes = ds.dsBm.bmWidthBytes * ds.dsBm.bmHeight;
+	if (bytes > PICTURE_CACHE_MAX_BYTES / 4) // Huge images would evict too many others, and are less likely to be reused.
+		return;
+
+	int i, lru_index;
+	while (sPictureCacheCount == PICTURE_CACHE_SIZE || sPictureCacheBytes + bytes > PICTURE_CACHE_MAX_BYTES)
+	{
+		for (lru_index = 0, i = 1; i < sPictureCacheCount; ++i)
+			if (sPictureCacheClock - sPictureCache[i].last_used > sPictureCacheClock - sPictureCache[lru_index].last_used)
+				lru_index = i;
+		PictureCacheRemove(lru_index);
+	}
+
+	HBITMAP hbitmap = (HBITMAP)CopyImage(aBitmap, IMAGE_BITMAP, 0, 0, is_dib ? LR_CREATEDIBSECTION : 0);
+	if (!hbitmap)
+		return;
+	PictureCacheEntry &entry = sPictureCache[sPictureCacheCount++];
+	entry.hbitmap = hbitmap;
+	entry.bytes = bytes;
+	entry.last_used = ++sPictureCacheClock;
+	entry.last_write_time = aFileData.ftLastWriteTime;
+	entry.file_size_low = aFileData.nFileSizeLow;
+	entry.file_size_high = aFileData.nFileSizeHigh;
+	entry.width = aWidth;
+	entry.height = aHeight;
+	entry.use_gdi_plus = aUseGDIPlusIfAvailable;
+	entry.is_dib = is_dib;
+	strcpy(entry.filespec, aFullPath); // Caller has ensured it fits.
+	sPictureCacheBytes += bytes;
+}
+
+
+
+void GetPictureCacheStats(int &aCount, DWORD &aBytes, DWORD &aHits, DWORD &aMisses)
+{
+	aCount = sPictureCacheCount;
+	aBytes = sPictureCacheBytes;
+	aHits = sPictureCacheHits;
+	aMisses = sPictureCacheMisses;
+}
+
+
+
+HBITMAP LoadPicture(char *aFilespec, int aWidth, int aHeight, int &aImageType, int aIconNumber
+	, bool aUseGDIPlusIfAvailable)
+// Returns NULL on failure.  See LoadPictureFromFile() for details about the parameters and the types
+// of image returned.  Bitmaps are copied from the cache above whenever possible, so the caller owns
+// the returned handle in all cases.
+{
+	// Resolve GetFileAttributesEx() dynamically because it doesn't exist on Win95:
+	typedef BOOL (WINAPI *MyGetFileAttributesExType)(LPCSTR, GET_FILEEX_INFO_LEVELS, LPVOID);
+	static MyGetFileAttributesExType MyGetFileAttributesEx = (MyGetFileAttributesExType)GetProcAddress(GetModuleHandle("kernel32"), "GetFileAttributesExA");
+
+	char full_path[MAX_PATH], *filename_marker;
+	WIN32_FILE_ATTRIBUTE_DATA file_data;
+	DWORD length;
+	if (!*aFilespec || aIconNumber > 0 || !MyGetFileAttributesEx // Caller wants an icon, or the cache isn't possible.
+		// The full path is used so that a change in the working directory can't yield the wrong image:
+		|| !(length = GetFullPathName(aFilespec, sizeof(full_path), full_path, &filename_marker))
+		|| length >= sizeof(full_path)
+		|| !MyGetFileAttributesEx(full_path, GetFileExInfoStandard, &file_data))
+		return LoadPictureFromFile(aFilespec, aWidth, aHeight, aImageType, aIconNumber, aUseGDIPlusIfAvailable);
+
+	HBITMAP hbitmap;
+	for (int i = 0; i < sPictureCacheCount; ++i)
+	{
+		PictureCacheEntry &entry = sPictureCache[i];
+		if (entry.width != aWidth || entry.height != aHeight || entry.use_gdi_plus != aUseGDIPlusIfAvailable
+			|| stricmp(entry.filespec, full_path))
+			continue;
+		if (CompareFileTime(&entry.last_write_time, &file_data.ftLastWriteTime)
+			|| entry.file_size_low != file_data.nFileSizeLow || entry.file_size_high != file_data.nFileSizeHigh)
+		{
+			PictureCacheRemove(i); // The file has changed since it was cached.
+			break;
+		}
+		if (hbitmap = (HBITMAP)CopyImage(entry.hbitmap, IMAGE_BITMAP, 0, 0, entry.is_dib ? LR_CREATEDIBSECTION : 0))
+		{
+			entry.last_used = ++sPictureCacheClock;
+			++sPictureCacheHits;
+			aImageType = IMAGE_BITMAP;
+			return hbitmap;
+		}
+		break; // Copy failed (e.g. low on GDI resources), so fall back to loading the file.
+	}
+
+	++sPictureCacheMisses;
+	hbitmap = LoadPictureFromFile(aFilespec, aWidth, aHeight, aImageType, aIconNumber, aUseGDIPlusIfAvailable);
+	if (hbitmap && aImageType == IMAGE_BITMAP)
+		PictureCacheAdd(hbitmap, full_path, file_data, aWidth, aHeight, aUseGDIPlusIfAvailable);
+	return hbitmap;
+}
+
+
+
 HBITMAP IconToBitmap(HICON ahIcon, bool aDestroyIcon)
 // Converts HICON to an HBITMAP that has ahIcon's actual dimensions.
 // The incoming ahIcon will be destroyed if the caller passes true for aDestroyIcon.
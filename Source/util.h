@@ -518,6 +518,13 @@ inline char *UTOA(unsigned long value, char *buf)
 
 int GetYDay(int aMon, int aDay, bool aIsLeapYear);
 int GetISOWeekNumber(char *aBuf, int aYear, int aYDay, int aWDay);
+#define MAX_FILETIME_SECONDS (0x7FFFFFFFFFFFFFFF / 10000000) // The largest FILETIME that FileTimeToSystemTime() accepts.
+int DaysFromCivil(int aYear, int aMonth, int aDay);
+void CivilFromDays(int aDays, int &aYear, int &aMonth, int &aDay);
+bool SystemTimeIsValid(SYSTEMTIME &aTime);
+ResultType YYYYMMDDToSeconds(char *aYYYYMMDD, __int64 &aSeconds);
+char *SecondsToYYYYMMDD(char *aBuf, __int64 aSeconds);
+__int64 GetLocalTimeTicks();
 ResultType YYYYMMDDToFileTime(char *aYYYYMMDD, FILETIME &aFileTime);
 DWORD YYYYMMDDToSystemTime2(char *aYYYYMMDD, SYSTEMTIME *aSystemTime);
 ResultType YYYYMMDDToSystemTime(char *aYYYYMMDD, SYSTEMTIME &aSystemTime, bool aDoValidate);
@@ -544,12 +551,14 @@ int PredictReplacementSize(int aLengthDelta, int aReplacementCount, int aLimit,
 	, int aCurrentLength, int aEndOffsetOfCurrMatch);
 char *TranslateLFtoCRLF(char *aString);
 bool DoesFilePatternExist(char *aFilePattern, DWORD *aFileAttr = NULL);
+HANDLE FindFirstFileBatched(char *aFilePattern, WIN32_FIND_DATA &aFindData, bool aDirectoriesOnly = false);
 #ifdef _DEBUG
 	ResultType FileAppend(char *aFilespec, char *aLine, bool aAppendNewline = true);
 #endif
 char *ConvertFilespecToCorrectCase(char *aFullFileSpec);
 char *FileAttribToStr(char *aBuf, DWORD aAttr);
 unsigned __int64 GetFileSize64(HANDLE aFileHandle);
+unsigned __int64 GetTickCount64Ex();
 char *GetLastErrorText(char *aBuf, int aBufSize, bool aUpdateLastError = false);
 void AssignColor(char *aColorName, COLORREF &aColor, HBRUSH &aBrush);
 COLORREF ColorNameToBGR(char *aColorName);
@@ -569,6 +578,7 @@ DWORD ReadRegString(HKEY aRootKey, char *aSubkey, char *aValueName, char *aBuf,
 
 HBITMAP LoadPicture(char *aFilespec, int aWidth, int aHeight, int &aImageType, int aIconNumber
 	, bool aUseGDIPlusIfAvailable);
+void GetPictureCacheStats(int &aCount, DWORD &aBytes, DWORD &aHits, DWORD &aMisses);
 HBITMAP IconToBitmap(HICON ahIcon, bool aDestroyIcon);
 int CALLBACK FontEnumProc(ENUMLOGFONTEX *lpelfe, NEWTEXTMETRICEX *lpntme, DWORD FontType, LPARAM lParam);
 bool IsStringInList(char *aStr, char *aList, bool aFindExactMatch);